@@ -32,8 +32,12 @@
 #include "barrierCommand.h"
 #include "exception.h"
 
+#include <lunchbox/clock.h>
 #include <lunchbox/monitor.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
 #include <lunchbox/stdExt.h>
+#include <lunchbox/thread.h>
 
 namespace co
 {
@@ -58,10 +62,13 @@ namespace detail
 class Barrier
 {
 public:
-    Barrier() : height( 0 ) {}
+    Barrier() : height( 0 ), options( co::Barrier::OPTION_NONE ), entered( 0 )
+    {}
     Barrier( const uint128_t& masterID_, const uint32_t height_ )
         : masterID( masterID_ )
         , height( height_ )
+        , options( co::Barrier::OPTION_NONE )
+        , entered( 0 )
     {}
 
     /** The master barrier node. */
@@ -78,6 +85,15 @@ public:
 
     /** The monitor used for barrier leave notification. */
     lunchbox::Monitor< uint32_t > incarnation;
+
+    /** The local enter options, see co::Barrier::Option. */
+    uint32_t options;
+
+    /** Protects entered for OPTION_LOCAL. */
+    lunchbox::SpinLock lock;
+
+    /** Number of local threads in the barrier for OPTION_LOCAL. */
+    uint32_t entered;
 };
 }
 
@@ -154,12 +170,22 @@ uint32_t Barrier::getHeight() const
     return _impl->height;
 }
 
+void Barrier::setOptions( const uint32_t options )
+{
+    _impl->options = options;
+}
+
+uint32_t Barrier::getOptions() const
+{
+    return _impl->options;
+}
+
 void Barrier::attach( const UUID& id, const uint32_t instanceID )
 {
     Object::attach( id, instanceID );
 
     LocalNodePtr node = getLocalNode();
-    CommandQueue* queue = node->getCommandThreadQueue();
+    CommandQueue* queue = node->getCommandThreadQueue( id );
 
     registerCommand( CMD_BARRIER_ENTER,
                      CmdFunc( this, &Barrier::_cmdEnter ), queue );
@@ -182,6 +208,12 @@ void Barrier::enter( const uint32_t timeout )
     if( _impl->height == 1 ) // trivial ;)
         return;
 
+    if( _impl->options & OPTION_LOCAL )
+    {
+        _enterLocal( timeout );
+        return;
+    }
+
     if( !_impl->master )
     {
         LocalNodePtr localNode = getLocalNode();
@@ -202,18 +234,79 @@ void Barrier::enter( const uint32_t timeout )
 
     const uint32_t leaveVal = _impl->incarnation.get() + 1;
 
-    send( _impl->master, CMD_BARRIER_ENTER )
+    sendControl( _impl->master, CMD_BARRIER_ENTER )
         << getVersion() << leaveVal - 1 << timeout;
 
-    if( timeout == LB_TIMEOUT_INDEFINITE )
-        _impl->incarnation.waitEQ( leaveVal );
-    else if( !_impl->incarnation.timedWaitEQ( leaveVal, timeout ))
-        throw Exception( Exception::TIMEOUT_BARRIER );
+    _wait( leaveVal, timeout );
 
     LBLOG( LOG_BARRIER ) << "left barrier " << getID() << " v" << getVersion()
                          << ", height " << _impl->height << std::endl;
 }
 
+void Barrier::_enterLocal( const uint32_t timeout )
+{
+    LBLOG( LOG_BARRIER ) << "enter local barrier " << getID() << " v"
+                         << getVersion() << ", height " << _impl->height
+                         << std::endl;
+    uint32_t leaveVal;
+    {
+        lunchbox::ScopedFastWrite mutex( _impl->lock );
+        leaveVal = _impl->incarnation.get() + 1;
+        if( ++_impl->entered >= _impl->height )
+        {
+            _impl->entered = 0;
+            ++_impl->incarnation;
+            return;
+        }
+    }
+
+    try
+    {
+        _wait( leaveVal, timeout );
+    }
+    catch( const Exception& )
+    {
+        lunchbox::ScopedFastWrite mutex( _impl->lock );
+        if( _impl->incarnation.get() >= leaveVal ) // released meanwhile
+            return;
+        --_impl->entered;
+        throw;
+    }
+}
+
+void Barrier::_wait( const uint32_t leaveVal, uint32_t timeout )
+{
+    const bool finite = timeout != LB_TIMEOUT_INDEFINITE &&
+                        timeout != LB_TIMEOUT_DEFAULT;
+    if( _impl->options & OPTION_SPIN )
+    {
+        float spinTime = float( Global::getIAttribute(
+                                    Global::IATTR_BARRIER_SPIN_TIME )) / 1000.f;
+        if( finite )
+            spinTime = LB_MIN( spinTime, float( timeout ));
+
+        lunchbox::Clock clock;
+        while( clock.getTimef() < spinTime )
+        {
+            if( _impl->incarnation.get() >= leaveVal )
+                return;
+            lunchbox::Thread::yield();
+        }
+
+        // the spinning counts against the timeout of the caller
+        if( finite )
+        {
+            const uint32_t spent = uint32_t( clock.getTimef( ));
+            timeout = spent < timeout ? timeout - spent : 0;
+        }
+    }
+
+    if( timeout == LB_TIMEOUT_INDEFINITE )
+        _impl->incarnation.waitGE( leaveVal );
+    else if( !_impl->incarnation.timedWaitGE( leaveVal, timeout ))
+        throw Exception( Exception::TIMEOUT_BARRIER );
+}
+
 bool Barrier::_cmdEnter( ICommand& cmd )
 {
     LB_TS_THREAD( _thread );
@@ -326,7 +419,7 @@ void Barrier::_sendNotify( const uint128_t& version, NodePtr node )
     else
     {
         LBLOG( LOG_BARRIER ) << "Unlock " << node << std::endl;
-        send( node, CMD_BARRIER_ENTER_REPLY ) << version;
+        sendControl( node, CMD_BARRIER_ENTER_REPLY ) << version;
     }
 }
 
@@ -38,6 +38,19 @@ namespace detail { class Barrier; }
 class Barrier : public Object
 {
 public:
+    /** Local tuning options for enter(), not distributed. @version 1.1.1 */
+    enum Option
+    {
+        OPTION_NONE  = 0,       //!< block on enter() using the command thread
+        /** Spin IATTR_BARRIER_SPIN_TIME microseconds before blocking */
+        OPTION_SPIN  = LB_BIT1,
+        /**
+         * All participants enter this instance from threads of this process.
+         * The barrier is resolved in-process, without sending any command.
+         */
+        OPTION_LOCAL = LB_BIT2
+    };
+
 #ifdef COLLAGE_V1_API
     /** @deprecated Does not register or map barrier. */
     CO_API Barrier( NodePtr master = 0, const uint32_t height = 0 );
@@ -102,6 +115,20 @@ public:
 
     /** @return the number of participants. @version 1.0 */
     CO_API uint32_t getHeight() const;
+
+    /**
+     * Set the local enter() options of this instance.
+     *
+     * The options are not distributed and may differ between instances. They
+     * may not be changed while a thread is in enter().
+     *
+     * @param options a bitwise combination of Option values.
+     * @version 1.1.1
+     */
+    CO_API void setOptions( const uint32_t options );
+
+    /** @return the local enter() options of this instance. @version 1.1.1 */
+    CO_API uint32_t getOptions() const;
     //@}
 
     /** @name Operations */
@@ -132,6 +159,8 @@ protected:
 private:
     detail::Barrier* const _impl;
 
+    void _enterLocal( const uint32_t timeout );
+    void _wait( const uint32_t leaveVal, const uint32_t timeout );
     void _cleanup( const uint64_t time );
     void _sendNotify( const uint128_t& version, NodePtr node );
 
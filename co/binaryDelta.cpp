@@ -0,0 +1,120 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "binaryDelta.h"
+
+#include "dataIStream.h"
+#include "dataOStream.h"
+#include "log.h"
+
+namespace co
+{
+namespace
+{
+typedef std::pair< uint64_t, uint64_t > Range; // offset, size
+typedef std::vector< Range > Ranges;
+
+/** @return the changed byte ranges, aligned to BinaryDelta::blockSize. */
+uint64_t _compare( const lunchbox::Bufferb& previous,
+                   const lunchbox::Bufferb& current, Ranges& ranges )
+{
+    const uint64_t size = current.getSize();
+    const uint64_t common = LB_MIN( size, previous.getSize( ));
+    uint64_t nBytes = 0;
+
+    for( uint64_t i = 0; i < size; i += BinaryDelta::blockSize )
+    {
+        const uint64_t block = LB_MIN( BinaryDelta::blockSize, size - i );
+        if( i + block <= common &&
+            ::memcmp( previous.getData() + i, current.getData() + i,
+                      block ) == 0 )
+        {
+            continue;
+        }
+
+        if( !ranges.empty() &&
+            ranges.back().first + ranges.back().second == i )
+        {
+            ranges.back().second += block;
+        }
+        else
+            ranges.push_back( Range( i, block ));
+        nBytes += block + 2 * sizeof( uint64_t );
+    }
+    return nBytes;
+}
+}
+
+bool BinaryDelta::encode( DataOStream& os, const uint128_t& base,
+                          const lunchbox::Bufferb& previous,
+                          const lunchbox::Bufferb& current )
+{
+    const uint64_t size = current.getSize();
+    Ranges ranges;
+    bool delta = base != VERSION_NONE &&
+                 _compare( previous, current, ranges ) <= size / 2;
+    if( !delta )
+    {
+        ranges.clear();
+        if( size > 0 )
+            ranges.push_back( Range( 0, size ));
+    }
+
+    os << size << ( delta ? base : VERSION_NONE ) << previous.getSize()
+       << uint64_t( ranges.size( ));
+    for( Ranges::const_iterator i = ranges.begin(); i != ranges.end(); ++i )
+        os << i->first << i->second
+           << Array< const uint8_t >( current.getData() + i->first,
+                                      i->second );
+    return delta;
+}
+
+bool BinaryDelta::decode( DataIStream& is, const uint128_t& version,
+                          lunchbox::Bufferb& data )
+{
+    uint64_t size = 0;
+    uint128_t base;
+    uint64_t baseSize = 0;
+    uint64_t nRanges = 0;
+    is >> size >> base >> baseSize;
+
+    if( base != VERSION_NONE &&
+        ( base != version || baseSize != data.getSize( )))
+    {
+        return false;
+    }
+
+    is >> nRanges;
+    data.resize( size );
+    for( uint64_t i = 0; i < nRanges; ++i )
+    {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        is >> offset >> length;
+        if( offset > size || length > size - offset )
+        {
+            LBERROR << "Binary delta range " << offset << "+" << length
+                    << " exceeds data size " << size << std::endl;
+            return false;
+        }
+        is >> Array< uint8_t >( data.getData() + offset, length );
+    }
+    return true;
+}
+}
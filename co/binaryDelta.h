@@ -0,0 +1,73 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_BINARYDELTA_H
+#define CO_BINARYDELTA_H
+
+#include <co/api.h>
+#include <co/types.h>
+
+#include <lunchbox/buffer.h> // used inline
+
+namespace co
+{
+/** @internal
+ * Block-wise binary delta between two serialized versions of an object.
+ *
+ * The encoder compares the previous and the current instance data in blocks
+ * of a fixed size and writes the changed block ranges. The decoder patches
+ * these ranges into a copy of the previous instance data. If the delta would
+ * not be smaller than half of the current data, the full data is written
+ * instead, which the decoder applies without a base version.
+ */
+class BinaryDelta
+{
+public:
+    /** The comparison granularity in bytes. */
+    static const uint64_t blockSize = 64;
+
+    /**
+     * Write the delta from previous to current.
+     *
+     * @param os the output stream.
+     * @param base the version of the previous data, VERSION_NONE for full.
+     * @param previous the previous instance data.
+     * @param current the current instance data.
+     * @return true if a delta was written, false for full data.
+     */
+    CO_API static bool encode( DataOStream& os, const uint128_t& base,
+                               const lunchbox::Bufferb& previous,
+                               const lunchbox::Bufferb& current );
+
+    /**
+     * Apply a delta written by encode() to the given data.
+     *
+     * @param is the input stream.
+     * @param version the version of the given data.
+     * @param data the data to patch.
+     * @return false if the delta is not based on the given data, which is
+     *         unchanged in this case, or if the delta is malformed, which
+     *         leaves the data undefined.
+     */
+    CO_API static bool decode( DataIStream& is, const uint128_t& version,
+                               lunchbox::Bufferb& data );
+};
+}
+
+#endif // CO_BINARYDELTA_H
@@ -0,0 +1,55 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bufferDataIStream.h"
+
+#include "commands.h"
+#include "localNode.h"
+
+#include <lunchbox/plugins/compressor.h>
+
+namespace co
+{
+BufferDataIStream::BufferDataIStream( const lunchbox::Bufferb& data,
+                                      DataIStream& from )
+        : DataIStream( from.isSwapping( ))
+        , _data( data )
+        , _remoteNode( from.getRemoteNode( ))
+        , _localNode( from.getLocalNode( ))
+        , _read( false )
+        , _compact( from.isCompact( ))
+{}
+
+BufferDataIStream::~BufferDataIStream()
+{}
+
+bool BufferDataIStream::getNextBuffer( uint32_t& compressor, uint32_t& nChunks,
+                                       const void** chunkData, uint64_t& size )
+{
+    if( _read || _data.getSize() == 0 )
+        return false;
+
+    _read = true;
+    compressor = EQ_COMPRESSOR_NONE;
+    nChunks = _compact ? 1 | COMPACT_ENCODING : 1;
+    *chunkData = _data.getData();
+    size = _data.getSize();
+    return true;
+}
+}
@@ -0,0 +1,57 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_BUFFERDATAISTREAM_H
+#define CO_BUFFERDATAISTREAM_H
+
+#include <co/dataIStream.h> // base class
+
+namespace co
+{
+    /** @internal A DataIStream reading uncompressed data from memory. */
+    class BufferDataIStream : public DataIStream
+    {
+    public:
+        /**
+         * Construct a new input stream for the given data.
+         *
+         * The data has to stay valid during the lifetime of the stream. The
+         * endianness, the encoding and the nodes are taken from the given
+         * stream.
+         */
+        BufferDataIStream( const lunchbox::Bufferb& data, DataIStream& from );
+        virtual ~BufferDataIStream();
+
+        NodePtr getRemoteNode() const override { return _remoteNode; }
+        LocalNodePtr getLocalNode() const override { return _localNode; }
+
+    protected:
+        bool getNextBuffer( uint32_t& compressor, uint32_t& nChunks,
+                            const void** chunkData, uint64_t& size ) override;
+
+    private:
+        const lunchbox::Bufferb& _data;
+        NodePtr _remoteNode;
+        LocalNodePtr _localNode;
+        bool _read;
+        const bool _compact;
+    };
+}
+
+#endif // CO_BUFFERDATAISTREAM_H
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2005-2013, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2005-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *
  * This file is part of Collage <https://github.com/Eyescale/Collage>
  *
@@ -23,19 +23,295 @@
 #include "exception.h"
 #include "node.h"
 
-#include <lunchbox/mtQueue.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/condition.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
+
+#include <deque>
 
 namespace co
 {
 namespace detail
 {
+/**
+ * Lock-free multi-producer, single-consumer command queue.
+ *
+ * Producers append nodes with an atomic swap of the head, the consumer
+ * unlinks them from the tail (Vyukov's intrusive MPSC queue). The condition is
+ * only used to block the consumer on an empty queue and producers on a full
+ * queue. pushFront() is rare and uses a separate, spin-locked deque.
+ *
+ * Nodes are recycled through a lock-free free list over a preallocated pool,
+ * tagged against ABA. Only when the pool is exhausted are nodes allocated.
+ */
 class CommandQueue
 {
 public:
-    CommandQueue( const size_t maxSize ) : commands( maxSize ) {}
+    explicit CommandQueue( const size_t maxSize_ )
+        : maxSize( maxSize_ )
+        , size( 0 )
+        , head( &stub )
+        , tail( &stub )
+        , pool( new Node[ poolSize ] )
+        , freeList( 1 )
+        , nFront( 0 )
+        , nWaiting( 0 )
+    {
+        for( uint32_t i = 0; i < poolSize; ++i )
+        {
+            pool[ i ].pooled = true;
+            pool[ i ].nextFree = i + 1 < poolSize ? i + 2 : 0;
+        }
+    }
+
+    ~CommandQueue()
+    {
+        clear();
+        delete [] pool;
+    }
+
+    void push( const ICommand& command )
+    {
+        if( size_t( size ) >= maxSize )
+            _waitNotFull();
+
+        Node* node = _allocate( command );
+        ++size;
+        _link( node );
+        _notify();
+    }
+
+    void pushFront( const ICommand& command )
+    {
+        {
+            lunchbox::ScopedFastWrite mutex( frontLock );
+            ++nFront;
+            ++size;
+            front.push_front( command );
+        }
+        _notify();
+    }
+
+    bool pop( const uint32_t timeout, ICommand& command )
+    {
+        if( size == 0 && !_waitNotEmpty( timeout ))
+            return false;
+
+        while( !tryPop( command ))
+            lunchbox::Thread::yield(); // producer between exchange and link
+        return true;
+    }
+
+    bool tryPop( ICommand& command )
+    {
+        if( nFront > 0 )
+        {
+            lunchbox::ScopedFastWrite mutex( frontLock );
+            if( !front.empty( ))
+            {
+                command = front.front();
+                front.pop_front();
+                --nFront;
+                _unlinked();
+                return true;
+            }
+        }
+
+        Node* node = _unlink();
+        if( !node )
+            return false;
+
+        command = node->command;
+        _release( node );
+        _unlinked();
+        return true;
+    }
+
+    ICommands popAll( const uint32_t timeout )
+    {
+        ICommands commands;
+        ICommand command;
+        if( !pop( timeout, command ))
+            return commands;
+
+        commands.push_back( command );
+        while( tryPop( command ))
+            commands.push_back( command );
+        return commands;
+    }
+
+    /** Pop all commands, must not run concurrently with the consumer. */
+    void clear()
+    {
+        ICommand command;
+        while( size > 0 )
+            if( !tryPop( command ))
+                lunchbox::Thread::yield();
+    }
+
+    const size_t maxSize;
+
+    /** Number of queued commands, including ones not yet linked. */
+    lunchbox::a_ssize_t size;
+
+private:
+    struct Node
+    {
+        Node() : next( 0 ), pooled( false ), nextFree( 0 ) {}
+
+        ICommand command;
+        lunchbox::Atomic< Node* > next;
+        bool pooled;       //!< part of the preallocated pool
+        uint32_t nextFree; //!< pool index + 1 of the next free node, or 0
+    };
+
+    static const uint32_t poolSize = 256;
+
+    Node stub;
+    lunchbox::Atomic< Node* > head; //!< last pushed node, producers only
+    Node* tail;                //!< next node to pop, consumer only
 
-    /** Thread-safe buffer queue. */
-    lunchbox::MTQueue< co::ICommand > commands;
+    Node* const pool;
+    lunchbox::Atomic< uint64_t > freeList; //!< ABA tag << 32 | index + 1
+
+    lunchbox::SpinLock frontLock;
+    std::deque< ICommand > front;
+    lunchbox::a_ssize_t nFront;
+
+    lunchbox::Condition condition;
+    lunchbox::a_int32_t nWaiting; //!< threads blocked on condition
+
+    Node* _allocate( const ICommand& command )
+    {
+        uint64_t top = freeList;
+        while( uint32_t( top ) != 0 )
+        {
+            Node* node = &pool[ uint32_t( top ) - 1 ];
+            const uint64_t next = ((( top >> 32 ) + 1 ) << 32 ) |
+                                  node->nextFree;
+            if( freeList.compareAndSwap( top, next ))
+            {
+                node->command = command;
+                node->next = 0;
+                return node;
+            }
+            top = freeList;
+        }
+
+        Node* node = new Node; // pool exhausted
+        node->command = command;
+        return node;
+    }
+
+    void _release( Node* node )
+    {
+        node->command = ICommand(); // drop the buffer reference
+        if( !node->pooled )
+        {
+            delete node;
+            return;
+        }
+
+        const uint32_t index = uint32_t( node - pool ) + 1;
+        uint64_t top = freeList;
+        while( true )
+        {
+            node->nextFree = uint32_t( top );
+            const uint64_t next = ((( top >> 32 ) + 1 ) << 32 ) | index;
+            if( freeList.compareAndSwap( top, next ))
+                return;
+            top = freeList;
+        }
+    }
+
+    void _link( Node* node )
+    {
+        Node* previous = head;
+        while( !head.compareAndSwap( previous, node ))
+            previous = head;
+        previous->next = node; // publishes the node to the consumer
+    }
+
+    /** @return the oldest linked node, or 0 if none is available. */
+    Node* _unlink()
+    {
+        Node* node = tail;
+        Node* next = node->next;
+        if( node == &stub )
+        {
+            if( !next )
+                return 0;
+            tail = next;
+            node = next;
+            next = next->next;
+        }
+
+        if( next )
+        {
+            tail = next;
+            return node;
+        }
+
+        if( node != head )
+            return 0; // a producer has not linked its node yet
+
+        stub.next = 0;
+        _link( &stub );
+        next = node->next;
+        if( !next )
+            return 0;
+
+        tail = next;
+        return node;
+    }
+
+    void _unlinked()
+    {
+        --size;
+        if( nWaiting > 0 )
+            _broadcast();
+    }
+
+    void _notify()
+    {
+        if( nWaiting > 0 )
+            _broadcast();
+    }
+
+    void _broadcast()
+    {
+        condition.lock();
+        condition.broadcast();
+        condition.unlock();
+    }
+
+    bool _waitNotEmpty( const uint32_t timeout )
+    {
+        condition.lock();
+        ++nWaiting;
+        bool ok = true;
+        while( size == 0 && ok )
+        {
+            if( timeout == LB_TIMEOUT_INDEFINITE )
+                condition.wait();
+            else
+                ok = condition.timedWait( timeout );
+        }
+        --nWaiting;
+        condition.unlock();
+        return size > 0;
+    }
+
+    void _waitNotFull()
+    {
+        condition.lock();
+        ++nWaiting;
+        while( size_t( size ) >= maxSize )
+            condition.wait();
+        --nWaiting;
+        condition.unlock();
+    }
 };
 }
 
@@ -46,37 +322,40 @@ CommandQueue::CommandQueue( const size_t maxSize )
 
 CommandQueue::~CommandQueue()
 {
-    flush();
+    // the consumer has stopped, the destructor clears the queue
+    if( !isEmpty( ))
+        LBWARN << "Flushing non-empty command queue" << std::endl;
     delete _impl;
 }
 
 void CommandQueue::flush()
 {
+    LB_TS_THREAD( _thread );
     if( !isEmpty( ))
         LBWARN << "Flushing non-empty command queue" << std::endl;
 
-    _impl->commands.clear();
+    _impl->clear();
 }
 
 bool CommandQueue::isEmpty() const
 {
-    return _impl->commands.isEmpty();
+    return _impl->size == 0;
 }
 
 size_t CommandQueue::getSize() const
 {
-    return _impl->commands.getSize();
+    return size_t( _impl->size );
 }
 
 void CommandQueue::push( const ICommand& command )
 {
-    _impl->commands.push( command );
+    _impl->push( command );
 }
 
 void CommandQueue::pushFront( const ICommand& command )
 {
     LBASSERT( command.isValid( ));
-    _impl->commands.pushFront( command );
+    _impl->pushFront( command );
 }
 
 ICommand CommandQueue::pop( const uint32_t timeout )
@@ -84,7 +363,7 @@ ICommand CommandQueue::pop( const uint32_t timeout )
     LB_TS_THREAD( _thread );
 
     ICommand command;
-    if( !_impl->commands.timedPop( timeout, command ))
+    if( !_impl->pop( timeout, command ))
         throw Exception( Exception::TIMEOUT_COMMANDQUEUE );
 
     return command;
@@ -92,7 +371,8 @@ ICommand CommandQueue::pop( const uint32_t timeout )
 
 ICommands CommandQueue::popAll( const uint32_t timeout )
 {
-    const ICommands& result = _impl->commands.timedPopRange( timeout );
+    LB_TS_THREAD( _thread );
+    const ICommands& result = _impl->popAll( timeout );
 
     if( result.empty( ))
         throw Exception( Exception::TIMEOUT_COMMANDQUEUE );
@@ -103,7 +383,7 @@ ICommand CommandQueue::tryPop()
 {
     LB_TS_THREAD( _thread );
     ICommand command;
-    _impl->commands.tryPop( command );
+    _impl->tryPop( command );
     return command;
 }
 
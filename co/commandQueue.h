@@ -92,7 +92,12 @@ public:
      */
     CO_API bool isEmpty() const;
 
-    /** Flush all pending commands. @version 1.0 */
+    /**
+     * Flush all pending commands.
+     *
+     * Has to be called from the thread popping commands.
+     * @version 1.0
+     */
     CO_API void flush();
 
     /** @return the size of the queue. @version 1.0 */
@@ -51,6 +51,9 @@ static const size_t COMMAND_MINSIZE = 256;
 
 /** @internal Minimal allocation size of a packet. */
 static const size_t COMMAND_ALLOCSIZE = 4096; // Bigger than minSize!
+
+/** @internal Flag in the chunk count of a data header for compact data. */
+static const uint32_t COMPACT_ENCODING = 0x80000000u;
 }
 
 namespace lunchbox
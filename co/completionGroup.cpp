@@ -0,0 +1,85 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "completionGroup.h"
+
+#include <lunchbox/atomic.h>
+#include <lunchbox/monitor.h>
+
+#include <boost/bind.hpp>
+
+namespace co
+{
+namespace detail
+{
+class CompletionGroup
+{
+public:
+    CompletionGroup() : pending( 0 ), failed( 0 ) {}
+
+    void complete( const co::LocalNode::CompletionHandler& handler,
+                   const bool result )
+    {
+        if( handler )
+            handler( result );
+        if( !result )
+            ++failed;
+        --pending;
+    }
+
+    lunchbox::Monitor< size_t > pending;
+    lunchbox::a_int32_t failed;
+};
+}
+
+CompletionGroup::CompletionGroup()
+    : _impl( new detail::CompletionGroup )
+{}
+
+CompletionGroup::~CompletionGroup()
+{
+    _impl->pending.waitEQ( 0 );
+    delete _impl;
+}
+
+LocalNode::CompletionHandler CompletionGroup::add(
+    const LocalNode::CompletionHandler& handler )
+{
+    ++_impl->pending;
+    return boost::bind( &detail::CompletionGroup::complete, _impl, handler,
+                        _1 );
+}
+
+bool CompletionGroup::wait( const uint32_t timeout )
+{
+    if( !_impl->pending.timedWaitEQ( 0, timeout ))
+        return false;
+    return _impl->failed == 0;
+}
+
+size_t CompletionGroup::getNumPending() const
+{
+    return _impl->pending.get();
+}
+
+size_t CompletionGroup::getNumFailed() const
+{
+    return size_t( int32_t( _impl->failed ));
+}
+}
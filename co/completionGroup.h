@@ -0,0 +1,96 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_COMPLETIONGROUP_H
+#define CO_COMPLETIONGROUP_H
+
+#include <co/localNode.h> // CompletionHandler
+#include <boost/noncopyable.hpp>
+
+namespace co
+{
+namespace detail { class CompletionGroup; }
+
+/**
+ * Waits on the completion of many asynchronous operations at once.
+ *
+ * Each handler returned by add() is passed to one asynchronous operation,
+ * e.g., LocalNode::mapObject() or LocalNode::syncObject(). wait() blocks until
+ * all of them have been completed. The group has to outlive all operations
+ * using its handlers, the destructor waits for all pending operations.
+ * Operations whose master node disconnects complete with a failure.
+ *
+ * The handlers are called on the command thread of the local node. Do not
+ * destruct or wait() on a group from the command thread, or from within
+ * Object::applyInstanceData() or Object::applyMapData() of an operation in
+ * the group, since the remaining operations can not complete then.
+ *
+ * Example:
+ * @code
+ * co::CompletionGroup group;
+ * for( size_t i = 0; i < objects.size(); ++i )
+ *     node->mapObject( objects[i], ids[i], 0, co::VERSION_OLDEST,
+ *                      group.add( ));
+ * if( !group.wait( ))
+ *     LBWARN << "Mapping of some objects failed" << std::endl;
+ * @endcode
+ */
+class CompletionGroup : public boost::noncopyable
+{
+public:
+    /** Construct a new, empty completion group. @version 1.1.1 */
+    CO_API CompletionGroup();
+
+    /** Wait for all pending operations and destruct. @version 1.1.1 */
+    CO_API ~CompletionGroup();
+
+    /**
+     * Add a pending operation to this group.
+     *
+     * @param handler an optional handler called with the result of the
+     *                operation, before it is marked as completed.
+     * @return the handler to be passed to the asynchronous operation.
+     * @version 1.1.1
+     */
+    CO_API LocalNode::CompletionHandler
+    add( const LocalNode::CompletionHandler& handler =
+         LocalNode::CompletionHandler( ));
+
+    /**
+     * Wait for the completion of all pending operations.
+     *
+     * @param timeout the maximum time to wait in milliseconds.
+     * @return true if all operations completed successfully, false if one
+     *         failed or on timeout.
+     * @version 1.1.1
+     */
+    CO_API bool wait( const uint32_t timeout = LB_TIMEOUT_INDEFINITE );
+
+    /** @return the number of not yet completed operations. @version 1.1.1 */
+    CO_API size_t getNumPending() const;
+
+    /** @return the number of failed operations. @version 1.1.1 */
+    CO_API size_t getNumFailed() const;
+
+private:
+    detail::CompletionGroup* const _impl;
+};
+}
+
+#endif // CO_COMPLETIONGROUP_H
@@ -24,12 +24,15 @@
 #include "connectionDescription.h"
 #include "connectionListener.h"
 #include "log.h"
+#include "oCommand.h"
 #include "pipeConnection.h"
 #include "socketConnection.h"
 #include "rspConnection.h"
 
 #ifdef _WIN32
 #  include "namedPipeConnection.h"
+#else
+#  include "stripedConnection.h"
 #endif
 
 #include <co/exception.h>
@@ -84,6 +87,12 @@ public:
     BufferPtr buffer; //!< Current async read buffer
     uint64_t bytes; //!< Current read request size
 
+    bool compactSend; //!< Send commands without padding
+    bool compactReceive; //!< Receive commands without padding
+
+    uint64_t coalesceSize; //!< Coalesce sends up to this size, 0 to disable
+    lunchbox::Bufferb coalesced; //!< Pending small sends, protected by sendLock
+
     /** The listeners on state changes */
     ConnectionListeners listeners;
 
@@ -91,6 +100,9 @@ public:
             : state( co::Connection::STATE_CLOSED )
             , description( new ConnectionDescription )
             , bytes( 0 )
+            , compactSend( false )
+            , compactReceive( false )
+            , coalesceSize( 0 )
     {
         description->type = CONNECTIONTYPE_NONE;
     }
@@ -157,6 +169,10 @@ ConnectionPtr Connection::create( ConnectionDescriptionPtr description )
         case CONNECTIONTYPE_NAMEDPIPE:
             connection = new NamedPipeConnection;
             break;
+#else
+        case CONNECTIONTYPE_TCPIP_STRIPED:
+            connection = new StripedConnection;
+            break;
 #endif
 
         case CONNECTIONTYPE_RSP:
@@ -219,6 +235,41 @@ void Connection::unlockSend() const
     _impl->sendLock.unset();
 }
 
+void Connection::setCompactSend( const bool compact )
+{
+    _impl->compactSend = compact;
+}
+
+bool Connection::isCompactSend() const
+{
+    return _impl->compactSend;
+}
+
+void Connection::setCompactReceive( const bool compact )
+{
+    _impl->compactReceive = compact;
+}
+
+void Connection::setCoalescing( const uint64_t size )
+{
+    lunchbox::ScopedMutex<> mutex( _impl->sendLock );
+    _flush();
+    _impl->coalesceSize = isMulticast() ? 0 : size;
+    if( size > 0 )
+        _impl->coalesced.reserve( size );
+}
+
+bool Connection::flush()
+{
+    lunchbox::ScopedMutex<> mutex( _impl->sendLock );
+    return _flush();
+}
+
+uint64_t Connection::getHeaderReceiveSize() const
+{
+    return _impl->compactReceive ? OCommand::getSize() : COMMAND_MINSIZE;
+}
+
 void Connection::addListener( ConnectionListener* listener )
 {
     _impl->listeners.push_back( listener );
@@ -368,6 +419,39 @@ bool Connection::send( const void* buffer, const uint64_t bytes,
         LBINFO << "send:" << lunchbox::format( ptr, bytes ) << std::endl;
 #endif
 
+    if( _impl->coalesceSize > 0 )
+    {
+        lunchbox::Bufferb& coalesced = _impl->coalesced;
+        if( coalesced.getSize() + bytes < _impl->coalesceSize )
+        {
+            coalesced.append( ptr, bytes );
+            return true;
+        }
+        // preserve ordering with the pending small sends
+        if( !_flush( ))
+            return false;
+        if( bytes < _impl->coalesceSize )
+        {
+            coalesced.append( ptr, bytes );
+            return true;
+        }
+    }
+    return _write( ptr, bytes );
+}
+
+bool Connection::_flush()
+{
+    lunchbox::Bufferb& coalesced = _impl->coalesced;
+    if( coalesced.isEmpty( ))
+        return true;
+
+    const bool ok = _write( coalesced.getData(), coalesced.getSize( ));
+    coalesced.setSize( 0 );
+    return ok;
+}
+
+bool Connection::_write( const uint8_t* ptr, const uint64_t bytes )
+{
     uint64_t bytesLeft = bytes;
     while( bytesLeft )
     {
@@ -233,6 +233,39 @@ public:
 
     /** @internal Finish all pending send operations. */
     virtual void finish() {}
+
+    /**
+     * @internal Coalesce small sends into a single write.
+     *
+     * Sends smaller than the given size are accumulated and written when the
+     * accumulated data reaches the size, when a larger send is issued, or when
+     * flush() is called. A size of zero disables coalescing.
+     */
+    CO_API void setCoalescing( const uint64_t size );
+
+    /** @internal Write all coalesced data. @return false on write error. */
+    CO_API bool flush();
+    //@}
+
+    /** @internal @name Command framing, negotiated during node connect */
+    //@{
+    /**
+     * @internal Send commands with their exact size.
+     *
+     * By default, commands are padded to COMMAND_MINSIZE, which allows the
+     * receiver to read a fixed-size header. Compact framing omits the padding
+     * and requires the peer to receive using compact framing.
+     */
+    CO_API void setCompactSend( const bool compact );
+
+    /** @internal @return true if commands are send without padding. */
+    CO_API bool isCompactSend() const;
+
+    /** @internal Receive commands with their exact size, see above. */
+    CO_API void setCompactReceive( const bool compact );
+
+    /** @internal @return the size of the header read for a command. */
+    CO_API uint64_t getHeaderReceiveSize() const;
     //@}
 
     /**
@@ -320,6 +353,10 @@ protected:
 
 private:
     detail::Connection* const _impl;
+    friend class StripedConnection; // uses the low-level IO of its sockets
+
+    bool _write( const uint8_t* ptr, const uint64_t bytes );
+    bool _flush();
 };
 
 CO_API std::ostream& operator << ( std::ostream&, const Connection& );
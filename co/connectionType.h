@@ -36,6 +36,7 @@ namespace co
         CONNECTIONTYPE_IB,        //!< @deprecated Win XP Infiniband RDMA
         CONNECTIONTYPE_RDMA,      //!< Infiniband RDMA CM
         CONNECTIONTYPE_UDT,       //!< UDT connection
+        CONNECTIONTYPE_TCPIP_STRIPED, //!< Multiple TCP/IP sockets
         CONNECTIONTYPE_MULTICAST = 0x100, //!< @internal MC types after this:
         CONNECTIONTYPE_RSP        //!< UDP-based reliable stream protocol
     };
@@ -54,6 +55,7 @@ namespace co
             case CONNECTIONTYPE_NONE: return os << "NONE";
             case CONNECTIONTYPE_RDMA: return os << "RDMA";
             case CONNECTIONTYPE_UDT: return os << "UDT";
+            case CONNECTIONTYPE_TCPIP_STRIPED: return os << "TCPIP_STRIPED";
 
             default:
                 LBASSERTINFO( false, "Not implemented" );
@@ -20,6 +20,7 @@
 
 #include "dataIStream.h"
 
+#include "commands.h"
 #include "global.h"
 #include "log.h"
 #include "node.h"
@@ -62,10 +63,12 @@ public:
 
 DataIStream::DataIStream( const bool swap_ )
         : _impl( new detail::DataIStream( swap_ ))
+        , _encoding( ENCODING_UNKNOWN )
 {}
 
 DataIStream::DataIStream( const DataIStream& rhs )
         : _impl( new detail::DataIStream( rhs._impl->swap ))
+        , _encoding( ENCODING_UNKNOWN )
 {}
 
 DataIStream::~DataIStream()
@@ -91,12 +94,18 @@ bool DataIStream::isSwapping() const
     return _impl->swap;
 }
 
+bool DataIStream::isCompact()
+{
+    return _isCompact();
+}
+
 void DataIStream::_reset()
 {
     _impl->input     = 0;
     _impl->inputSize = 0;
     _impl->position  = 0;
     _impl->swap      = false;
+    _encoding        = ENCODING_UNKNOWN;
 }
 
 void DataIStream::_read( void* data, uint64_t size )
@@ -124,6 +133,39 @@ void DataIStream::_read( void* data, uint64_t size )
     _impl->position += size;
 }
 
+uint64_t DataIStream::_readInteger( const bool isSigned )
+{
+    LBASSERT( _encoding == ENCODING_COMPACT );
+    if( !_checkBuffer( ))
+    {
+        LBUNREACHABLE;
+        LBERROR << "No more input data" << std::endl;
+        return 0;
+    }
+
+    // LEB128, written with one _write and therefore never split across buffers
+    const uint8_t* data = _impl->input + _impl->position;
+    const uint64_t left = _impl->inputSize - _impl->position;
+    uint64_t bits = 0;
+    uint64_t nBytes = 0;
+    for( unsigned shift = 0; ; shift += 7 )
+    {
+        if( nBytes == left || shift > 63 )
+        {
+            LBERROR << "Corrupt varint in input buffer" << std::endl;
+            LBUNREACHABLE;
+            break;
+        }
+
+        const uint8_t byte = data[ nBytes++ ];
+        bits |= uint64_t( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ))
+            break;
+    }
+    _impl->position += nBytes;
+    return isSigned ? ( bits >> 1 ) ^ ( 0 - ( bits & 1 )) : bits;
+}
+
 const void* DataIStream::getRemainingBuffer( const uint64_t size )
 {
     if( !_checkBuffer( ))
@@ -165,7 +207,13 @@ bool DataIStream::_checkBuffer()
         if( !getNextBuffer( compressor, nChunks, &data, _impl->inputSize ))
             return false;
 
-        _impl->input = _decompress( data, compressor, nChunks,
+        const Encoding encoding = ( nChunks & COMPACT_ENCODING ) ?
+                                  ENCODING_COMPACT : ENCODING_RAW;
+        LBASSERTINFO( _encoding == ENCODING_UNKNOWN || _encoding == encoding,
+                      "Integer encoding changes within one stream" );
+        _encoding = encoding;
+        _impl->input = _decompress( data, compressor,
+                                    nChunks & ~COMPACT_ENCODING,
                                     _impl->inputSize );
     }
     return true;
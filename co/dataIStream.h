@@ -50,6 +50,7 @@ public:
     virtual void reset() { _reset(); } //!< @internal
     void setSwapping( const bool onOff ); //!< @internal enable endian swap
     CO_API bool isSwapping() const; //!< @internal
+    CO_API bool isCompact(); //!< @internal @return true for varint data
     DataIStream& operator = ( const DataIStream& rhs ); //!< @internal
     //@}
 
@@ -61,7 +62,7 @@ public:
 
     /** Read a plain data item. @version 1.0 */
     template< class T > DataIStream& operator >> ( T& value )
-        { _read( &value, sizeof( value )); _swap( value ); return *this; }
+        { _readValue( value, boost::is_integral< T >( )); return *this; }
 
     /** Read a C array. @version 1.0 */
     template< class T > DataIStream& operator >> ( Array< T > array )
@@ -169,9 +170,42 @@ protected:
 private:
     detail::DataIStream* const _impl;
 
+    /** The integer encoding of the stream, latched from its first buffer. */
+    enum Encoding
+    {
+        ENCODING_UNKNOWN,
+        ENCODING_RAW,
+        ENCODING_COMPACT
+    };
+    Encoding _encoding; //!< checked inline for each integer
+
     /** Read a number of bytes from the stream into a buffer. */
     CO_API void _read( void* data, uint64_t size );
 
+    /** Read a varint written by a compact DataOStream. */
+    CO_API uint64_t _readInteger( const bool isSigned );
+
+    /** Read a plain data item. */
+    template< class T > void _readValue( T& value, const boost::false_type& )
+        { _read( &value, sizeof( value )); _swap( value ); }
+
+    /** Read an integer. */
+    template< class T > void _readValue( T& value, const boost::true_type& )
+    {
+        if( sizeof( T ) > 1 && sizeof( T ) <= 8 && _isCompact( ))
+            value = T( _readInteger( boost::is_signed< T >::value ));
+        else
+            _readValue( value, boost::false_type( ));
+    }
+
+    /** @return true if integers are varint-encoded. */
+    bool _isCompact()
+    {
+        if( _encoding == ENCODING_UNKNOWN )
+            _checkBuffer(); // latch the encoding of the first buffer
+        return _encoding == ENCODING_COMPACT;
+    }
+
     /**
      * Check that the current buffer has data left, get the next buffer is
      * necessary, return false if no data is left.
@@ -192,11 +226,52 @@ private:
         LBASSERTINFO( nElems < LB_BIT48,
                       "Out-of-sync DataIStream: " << nElems << " elements?" );
         value.resize( size_t( nElems ));
-        if( nElems > 0 )
+        if( nElems == 0 )
+            return *this;
+
+        if( isCompact() && sizeof( T ) > 1 &&
+            !boost::is_floating_point< T >::value )
+        {
+            for( uint64_t i = 0; i < nElems; ++i )
+                *this >> value[ i ];
+        }
+        else
             *this >> Array< T >( &value.front(), nElems );
         return *this;
     }
 
+    /** Read a std::set of unsigned integers, delta-encoded if compact. */
+    template< class T >
+    void _readSet( std::set< T >& value, const uint64_t nElems,
+                   const boost::true_type& )
+    {
+        if( nElems == 0 || !isCompact( ))
+        {
+            _readSet( value, nElems, boost::false_type( ));
+            return;
+        }
+
+        T last = 0;
+        for( uint64_t i = 0; i < nElems; ++i )
+        {
+            last = T( last + read< T >( ));
+            value.insert( value.end(), last );
+        }
+    }
+
+    /** Read a std::set of serializable items. */
+    template< class T >
+    void _readSet( std::set< T >& value, const uint64_t nElems,
+                   const boost::false_type& )
+    {
+        for( uint64_t i = 0; i < nElems; ++i )
+        {
+            T item;
+            *this >> item;
+            value.insert( item );
+        }
+    }
+
     /** Byte-swap a plain data item. @version 1.0 */
     template< class T > void _swap( T& value ) const
         { if( isSwapping( )) swap( value ); }
@@ -44,6 +44,36 @@ template<> inline DataIStream& DataIStream::operator >> ( std::string& str )
     return *this;
 }
 
+/** Read a 128 bit integer. */
+template<> inline DataIStream& DataIStream::operator >> ( uint128_t& value )
+{
+    if( !isCompact( ))
+    {
+        _read( &value, sizeof( value ));
+        _swap( value );
+        return *this;
+    }
+    uint64_t high = 0;
+    uint64_t low = 0;
+    *this >> high >> low;
+    value = uint128_t( high, low );
+    return *this;
+}
+
+/** Read an ObjectVersion. */
+template<> inline DataIStream& DataIStream::operator >> ( ObjectVersion& value )
+{
+    if( !isCompact( ))
+    {
+        _read( &value, sizeof( value ));
+        _swap( value );
+        return *this;
+    }
+    _read( &value.identifier, sizeof( value.identifier ));
+    _swap( value.identifier );
+    return *this >> value.version;
+}
+
 /** Deserialize an object (id+version). */
 template<> inline DataIStream& DataIStream::operator >> ( Object*& object )
 {
@@ -115,12 +145,9 @@ DataIStream::operator >> ( std::set< T >& value )
     value.clear();
     uint64_t nElems = 0;
     *this >> nElems;
-    for( uint64_t i = 0; i < nElems; ++i )
-    {
-        T item;
-        *this >> item;
-        value.insert( item );
-    }
+    _readSet( value, nElems, boost::integral_constant< bool,
+                                 boost::is_integral< T >::value &&
+                                 boost::is_unsigned< T >::value >( ));
     return *this;
 }
 
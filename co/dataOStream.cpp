@@ -93,6 +93,9 @@ public:
     /** Save all sent data */
     bool save;
 
+    /** Flush the connections after the last send */
+    bool flush;
+
     DataOStream()
         : state( STATE_UNCOMPRESSED )
         , bufferStart( 0 )
@@ -100,6 +103,7 @@ public:
         , enabled( false )
         , dataSent( false )
         , save( false )
+        , flush( false )
     {}
 
     DataOStream( const DataOStream& rhs )
@@ -109,6 +113,7 @@ public:
         , enabled( rhs.enabled )
         , dataSent( rhs.dataSent )
         , save( rhs.save )
+        , flush( rhs.flush )
     {}
 
     uint32_t getCompressor() const
@@ -188,11 +193,13 @@ public:
 
 DataOStream::DataOStream()
     : _impl( new detail::DataOStream )
+    , _compact( false )
 {}
 
 DataOStream::DataOStream( DataOStream& rhs )
     : lunchbox::NonCopyable()
     , _impl( new detail::DataOStream( *rhs._impl ))
+    , _compact( rhs._compact )
 {
     _setupConnections( rhs.getConnections( ));
     getBuffer().swap( rhs.getBuffer( ));
@@ -298,6 +305,16 @@ void DataOStream::disable()
         }
 
         sendData( ptr, size, true ); // always send to finalize istream
+
+        // write coalesced commands, the receivers wait for the last chunk
+        if( _impl->flush )
+        {
+            for( ConnectionsCIter i = _impl->connections.begin();
+                 i != _impl->connections.end(); ++i )
+            {
+                (*i)->flush();
+            }
+        }
     }
 
 #ifndef CO_AGGRESSIVE_CACHING
@@ -346,6 +363,23 @@ void DataOStream::_write( const void* data, uint64_t size )
     _impl->buffer.append( static_cast< const uint8_t* >( data ), size );
 }
 
+void DataOStream::_writeInteger( const uint64_t value, const bool isSigned )
+{
+    LBASSERT( _compact );
+
+    // LEB128, signed values are zigzag-encoded to keep small negatives short
+    uint64_t bits = isSigned ? ( value << 1 ) ^ ( 0 - ( value >> 63 )) : value;
+    uint8_t data[ 10 ];
+    size_t nBytes = 0;
+    while( bits >= 0x80 )
+    {
+        data[ nBytes++ ] = uint8_t( bits ) | 0x80;
+        bits >>= 7;
+    }
+    data[ nBytes++ ] = uint8_t( bits );
+    _write( data, nBytes ); // never split across buffers
+}
+
 void DataOStream::flush( const bool last )
 {
     LBASSERT( _impl->enabled );
@@ -411,9 +445,28 @@ lunchbox::Bufferb& DataOStream::getBuffer()
     return _impl->buffer;
 }
 
+void DataOStream::setCompact( const bool onOff )
+{
+    LBASSERTINFO( !_impl->enabled, "Can't change encoding of enabled stream" );
+    _compact = onOff;
+}
+
+bool DataOStream::isCompact() const
+{
+    return _compact;
+}
+
+void DataOStream::setFlushOnDisable( const bool onOff )
+{
+    _impl->flush = onOff;
+}
+
 DataOStream& DataOStream::streamDataHeader( DataOStream& os )
 {
-    os << _impl->getCompressor() << _impl->getNumChunks();
+    const uint32_t nChunks = _impl->getNumChunks();
+    LBASSERT( !( nChunks & COMPACT_ENCODING ));
+    os << _impl->getCompressor()
+       << ( _compact ? nChunks | COMPACT_ENCODING : nChunks );
     return os;
 }
 
@@ -73,13 +73,26 @@ namespace DataStreamTest { class Sender; }
 
         /** @internal @return the compressed data size, 0 if uncompressed.*/
         uint64_t getCompressedDataSize() const;
+
+        /** @internal Enable or disable the compact encoding of integers. */
+        CO_API void setCompact( const bool onOff );
+
+        /** @internal @return true if the compact encoding is used. */
+        CO_API bool isCompact() const;
+
+        /**
+         * @internal Write the coalesced sends of all receivers in disable().
+         *
+         * Used by streams which end a batch of commands, e.g., object data.
+         */
+        void setFlushOnDisable( const bool onOff );
         //@}
 
         /** @name Data output */
         //@{
         /** Write a plain data item by copying it to the stream. @version 1.0 */
         template< class T > DataOStream& operator << ( const T& value )
-            { _write( &value, sizeof( value )); return *this; }
+            { _writeValue( value, boost::is_integral< T >( )); return *this; }
 
         /** Write a C array. @version 1.0 */
         template< class T > DataOStream& operator << ( const Array< T > array )
@@ -173,6 +186,7 @@ namespace DataStreamTest { class Sender; }
 
     private:
         detail::DataOStream* const _impl;
+        bool _compact; //!< Write integers as varints, checked inline
 
         /** Collect compressed data. */
         CO_API uint64_t _getCompressedData( void** chunks,
@@ -181,6 +195,24 @@ namespace DataStreamTest { class Sender; }
         /** Write a number of bytes from data into the stream. */
         CO_API void _write( const void* data, uint64_t size );
 
+        /** Write an integer as a varint, used for compact streams only. */
+        CO_API void _writeInteger( const uint64_t value, const bool isSigned );
+
+        /** Write a plain data item. */
+        template< class T >
+        void _writeValue( const T& value, const boost::false_type& )
+            { _write( &value, sizeof( value )); }
+
+        /** Write an integer. */
+        template< class T >
+        void _writeValue( const T& value, const boost::true_type& )
+        {
+            if( _compact && sizeof( T ) > 1 && sizeof( T ) <= 8 )
+                _writeInteger( uint64_t( value ), boost::is_signed< T >::value );
+            else
+                _write( &value, sizeof( value ));
+        }
+
         /** Helper function preparing data for sendData() as needed. */
         void _sendData( const void* data, const uint64_t size );
 
@@ -192,12 +224,51 @@ namespace DataStreamTest { class Sender; }
         DataOStream& _writeFlatVector( const std::vector< T >& value )
         {
             const uint64_t nElems = value.size();
-            _write( &nElems, sizeof( nElems ));
-            if( nElems > 0 )
+            *this << nElems;
+            if( nElems == 0 )
+                return *this;
+
+            if( isCompact() && sizeof( T ) > 1 &&
+                !boost::is_floating_point< T >::value )
+            {
+                for( uint64_t i = 0; i < nElems; ++i )
+                    *this << value[ i ];
+            }
+            else
                 _write( &value.front(), nElems * sizeof( T ));
             return *this;
         }
 
+        /** Write a std::set of unsigned integers, delta-encoded if compact. */
+        template< class T >
+        void _writeSet( const std::set< T >& value, const boost::true_type& )
+        {
+            if( !isCompact( ))
+            {
+                _writeSet( value, boost::false_type( ));
+                return;
+            }
+
+            T last = 0;
+            for( typename std::set< T >::const_iterator it = value.begin();
+                 it != value.end(); ++it )
+            {
+                *this << T( *it - last );
+                last = *it;
+            }
+        }
+
+        /** Write a std::set of serializable items. */
+        template< class T >
+        void _writeSet( const std::set< T >& value, const boost::false_type& )
+        {
+            for( typename std::set< T >::const_iterator it = value.begin();
+                 it != value.end(); ++it )
+            {
+                *this << *it;
+            }
+        }
+
         /** Write an Array of POD data */
         template< class T >
         void _writeArray( const Array< T > array, const boost::true_type& )
@@ -28,13 +28,38 @@ template<>
 inline DataOStream& DataOStream::operator << ( const std::string& str )
 {
     const uint64_t nElems = str.length();
-    _write( &nElems, sizeof( nElems ));
+    *this << nElems;
     if ( nElems > 0 )
         _write( str.c_str(), nElems );
 
     return *this;
 }
 
+/** Write a 128 bit integer, as two varints in compact mode. */
+template<> inline
+DataOStream& DataOStream::operator << ( const uint128_t& value )
+{
+    if( isCompact( ))
+        return *this << value.high() << value.low();
+    _write( &value, sizeof( value ));
+    return *this;
+}
+
+/** Write an ObjectVersion. */
+template<> inline
+DataOStream& DataOStream::operator << ( const ObjectVersion& value )
+{
+    if( !isCompact( ))
+    {
+        _write( &value, sizeof( value ));
+        return *this;
+    }
+    // random identifiers do not benefit from varints
+    _write( &value.identifier, sizeof( value.identifier ));
+    *this << value.version;
+    return *this;
+}
+
 /** Write an object identifier and version. */
 template<> inline
 DataOStream& DataOStream::operator << ( const Object* const& object )
@@ -80,11 +105,9 @@ DataOStream& DataOStream::operator << ( const std::set< T >& value )
 {
     const uint64_t nElems = value.size();
     *this << nElems;
-    for( typename std::set< T >::const_iterator it = value.begin();
-         it != value.end(); ++it )
-    {
-        *this << *it;
-    }
+    _writeSet( value, boost::integral_constant< bool,
+                          boost::is_integral< T >::value &&
+                          boost::is_unsigned< T >::value >( ));
     return *this;
 }
 
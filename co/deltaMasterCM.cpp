@@ -41,15 +41,15 @@ DeltaMasterCM::~DeltaMasterCM()
 
 void DeltaMasterCM::_commit()
 {
-    if( !_slaves->empty( ))
+    if( !_receivers.empty( ))
     {
         _deltaData.reset();
-        _deltaData.enableCommit( _version + 1, *_slaves );
+        _deltaData.enableCommit( _version + 1, _receivers );
         _object->pack( _deltaData );
         _deltaData.disable();
     }
 
-    if( _slaves->empty() || _deltaData.hasSentData( ))
+    if( _receivers.empty() || _deltaData.hasSentData( ))
     {
         // save instance data
         InstanceData* instanceData = _newInstanceData();
@@ -0,0 +1,88 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "diffMasterCM.h"
+
+#include "binaryDelta.h"
+#include "log.h"
+#include "object.h"
+#include "objectDeltaDataOStream.h"
+#include "objectICommand.h"
+
+namespace co
+{
+typedef CommandFunc< DiffMasterCM > CmdFunc;
+
+DiffMasterCM::DiffMasterCM( Object* object )
+        : FullMasterCM( object )
+{
+    object->registerCommand( CMD_OBJECT_FULL_VERSION,
+                             CmdFunc( this, &DiffMasterCM::_cmdFullVersion ),
+                             0 );
+}
+
+DiffMasterCM::~DiffMasterCM()
+{}
+
+void DiffMasterCM::_commit()
+{
+    // buffer the full version without sending it
+    InstanceData* instanceData = _newInstanceData();
+    instanceData->os.enableCommit( _version + 1, Nodes( ));
+    _object->getInstanceData( instanceData->os );
+    instanceData->os.disable();
+
+    if( !instanceData->os.hasSentData( ))
+    {
+        _releaseInstanceData( instanceData );
+        return;
+    }
+
+    if( !_receivers.empty( ))
+    {
+        InstanceData* previous = _getHeadInstanceData();
+        ObjectDeltaDataOStream os( this );
+        os.enableCommit( _version + 1, _receivers );
+        BinaryDelta::encode( os, _version, previous->os.getSaveBuffer(),
+                             instanceData->os.getSaveBuffer( ));
+        os.disable();
+    }
+
+    ++_version;
+    LBASSERT( _version != VERSION_NONE );
+    _addInstanceData( instanceData );
+}
+
+//---------------------------------------------------------------------------
+// command handlers
+//---------------------------------------------------------------------------
+bool DiffMasterCM::_cmdFullVersion( ICommand& cmd )
+{
+    ObjectICommand command( cmd );
+    const uint32_t instanceID = command.get< uint32_t >();
+
+    Mutex mutex( _slaves );
+    LBLOG( LOG_OBJECTS ) << "Send full v" << _version << " of "
+                         << lunchbox::className( _object ) << " to "
+                         << command.getNode() << std::endl;
+    _getHeadInstanceData()->os.sendMapData( command.getNode(), instanceID );
+    return true;
+}
+
+}
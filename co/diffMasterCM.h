@@ -0,0 +1,51 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_DIFFMASTERCM_H
+#define CO_DIFFMASTERCM_H
+
+#include "fullMasterCM.h" // base class
+
+namespace co
+{
+    /**
+     * An object change manager sending binary deltas of the full versions to
+     * the slave instances.
+     *
+     * Buffers full versions like the FullMasterCM, but sends only the changed
+     * blocks of the instance data compared to the previous version. Slaves
+     * which can't apply a delta request the head version.
+     * @internal
+     */
+    class DiffMasterCM : public FullMasterCM
+    {
+    public:
+        DiffMasterCM( Object* object );
+        virtual ~DiffMasterCM();
+
+    protected:
+        void _commit() override;
+
+    private:
+        /* The command handlers. */
+        bool _cmdFullVersion( ICommand& command );
+    };
+}
+
+#endif // CO_DIFFMASTERCM_H
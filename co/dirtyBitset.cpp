@@ -0,0 +1,161 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "dirtyBitset.h"
+
+namespace co
+{
+namespace
+{
+static const uint64_t _one = 1;
+
+size_t _nWords( const size_t nBits ) { return ( nBits + 63 ) / 64; }
+}
+
+DirtyBitset::DirtyBitset( const size_t size )
+    : _size( 0 )
+{
+    resize( size );
+}
+
+void DirtyBitset::resize( const size_t size )
+{
+    const bool grow = size >= _size;
+    _size = size;
+    _bits.resize( _nWords( size ), 0 );
+    if( grow )
+    {
+        _blocks.resize( _nWords( _bits.size( )), 0 );
+        return;
+    }
+
+    if( size % 64 ) // clear bits beyond the new size in the last word
+        _bits.back() &= ( _one << ( size % 64 )) - 1;
+
+    _blocks.assign( _nWords( _bits.size( )), 0 );
+    for( size_t i = 0; i < _bits.size(); ++i )
+        if( _bits[i] )
+            _blocks[ i / 64 ] |= _one << ( i % 64 );
+}
+
+void DirtyBitset::set( const size_t index )
+{
+    if( index >= _size )
+        resize( index + 1 );
+
+    const size_t word = index / 64;
+    _bits[ word ] |= _one << ( index % 64 );
+    _blocks[ word / 64 ] |= _one << ( word % 64 );
+}
+
+void DirtyBitset::set( const size_t first, const size_t last )
+{
+    if( first >= last )
+        return;
+    if( last > _size )
+        resize( last );
+
+    for( size_t i = first; i < last; )
+    {
+        const size_t word = i / 64;
+        const size_t begin = i % 64;
+        const size_t end = LB_MIN( size_t( 64 ), begin + last - i );
+        const uint64_t mask = ( end == 64 ? ~uint64_t( 0 ) :
+                                ( _one << end ) - 1 ) & ~(( _one << begin ) - 1);
+
+        _bits[ word ] |= mask;
+        _blocks[ word / 64 ] |= _one << ( word % 64 );
+        i += end - begin;
+    }
+}
+
+void DirtyBitset::unset( const size_t index )
+{
+    if( index >= _size )
+        return;
+
+    const size_t word = index / 64;
+    _bits[ word ] &= ~( _one << ( index % 64 ));
+    if( _bits[ word ] == 0 )
+        _blocks[ word / 64 ] &= ~( _one << ( word % 64 ));
+}
+
+void DirtyBitset::clear()
+{
+    for( size_t i = 0; i < _blocks.size(); ++i )
+    {
+        // only touch words marked as modified
+        for( uint64_t block = _blocks[i]; block; block &= block - 1 )
+        {
+            size_t bit = 0;
+            while( !( block & ( _one << bit )))
+                ++bit;
+            _bits[ i * 64 + bit ] = 0;
+        }
+        _blocks[i] = 0;
+    }
+}
+
+bool DirtyBitset::isSet( const size_t index ) const
+{
+    if( index >= _size )
+        return false;
+    return _bits[ index / 64 ] & ( _one << ( index % 64 ));
+}
+
+bool DirtyBitset::isEmpty() const
+{
+    for( size_t i = 0; i < _blocks.size(); ++i )
+        if( _blocks[i] )
+            return false;
+    return true;
+}
+
+DirtyBitset::Ranges DirtyBitset::getRanges() const
+{
+    Ranges ranges;
+    for( size_t i = 0; i < _blocks.size(); ++i )
+    {
+        if( _blocks[i] == 0 ) // skip 4096 clean elements
+            continue;
+
+        for( size_t j = 0; j < 64; ++j )
+        {
+            if( !( _blocks[i] & ( _one << j )))
+                continue;
+
+            const size_t word = i * 64 + j;
+            const uint64_t bits = _bits[ word ];
+            for( size_t k = 0; k < 64; ++k )
+            {
+                if( !( bits & ( _one << k )))
+                    continue;
+
+                const size_t index = word * 64 + k;
+                if( !ranges.empty() && ranges.back().second == index )
+                    ++ranges.back().second;
+                else
+                    ranges.push_back( Range( index, index + 1 ));
+            }
+        }
+    }
+    return ranges;
+}
+
+}
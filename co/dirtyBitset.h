@@ -0,0 +1,180 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_DIRTYBITSET_H
+#define CO_DIRTYBITSET_H
+
+#include <co/api.h>
+#include <co/dataIStream.h> // used inline
+#include <co/dataOStream.h> // used inline
+#include <co/types.h>
+#include <lunchbox/log.h> // used inline
+
+namespace co
+{
+/**
+ * A hierarchical bitset tracking modified elements of a contiguous array.
+ *
+ * Complements the 64 dirty bits of a Serializable for objects with large
+ * arrays, where only few elements change between commits. The first level
+ * keeps one bit per element, the second level one bit per 64 elements, so
+ * that sparse changes in large arrays are found quickly.
+ *
+ * Typical usage together with Serializable::setDirtyBitset():
+ * @code
+ * void serialize( co::DataOStream& os, const uint64_t dirty ) override
+ * {
+ *     if( dirty & DIRTY_VALUES )
+ *         _dirtyValues.write( os, _values, dirty == DIRTY_ALL );
+ * }
+ * void deserialize( co::DataIStream& is, const uint64_t dirty ) override
+ * {
+ *     if( dirty & DIRTY_VALUES )
+ *         co::DirtyBitset::read( is, _values );
+ * }
+ * @endcode
+ */
+class DirtyBitset
+{
+public:
+    /** A range of elements [first, second). @version 1.1.1 */
+    typedef std::pair< size_t, size_t > Range;
+    typedef std::vector< Range > Ranges; //!< A list of ranges @version 1.1.1
+
+    /** Construct a new, clean bitset. @version 1.1.1 */
+    CO_API explicit DirtyBitset( const size_t size = 0 );
+
+    /**
+     * Resize the bitset, keeping the state of existing elements.
+     *
+     * New elements are clean. The bitset grows automatically when elements
+     * beyond its size are set.
+     * @version 1.1.1
+     */
+    CO_API void resize( const size_t size );
+
+    /** @return the number of tracked elements. @version 1.1.1 */
+    size_t getSize() const { return _size; }
+
+    /** Mark the given element as modified. @version 1.1.1 */
+    CO_API void set( const size_t index );
+
+    /** Mark the elements [first, last) as modified. @version 1.1.1 */
+    CO_API void set( const size_t first, const size_t last );
+
+    /** Mark the given element as unmodified. @version 1.1.1 */
+    CO_API void unset( const size_t index );
+
+    /** Mark all elements as unmodified. @version 1.1.1 */
+    CO_API void clear();
+
+    /** @return true if the given element is modified. @version 1.1.1 */
+    CO_API bool isSet( const size_t index ) const;
+
+    /** @return true if no element is modified. @version 1.1.1 */
+    CO_API bool isEmpty() const;
+
+    /** @return the ranges of modified elements in ascending order. @version 1.1.1 */
+    CO_API Ranges getRanges() const;
+
+    /**
+     * Write the modified elements of the given array.
+     *
+     * Writes the array size followed by all modified element ranges. The
+     * array may be larger than the bitset, elements beyond it are clean.
+     *
+     * @param os the output stream.
+     * @param data the array tracked by this bitset.
+     * @param all write all elements, e.g., for getInstanceData().
+     * @version 1.1.1
+     */
+    template< class T >
+    void write( DataOStream& os, const std::vector< T >& data,
+                const bool all = false ) const;
+
+    /**
+     * Read the elements written by write() into the given array.
+     *
+     * The array is resized to the size of the written array.
+     * @return false if the stream contains a range beyond the array.
+     * @version 1.1.1
+     */
+    template< class T >
+    static bool read( DataIStream& is, std::vector< T >& data );
+
+private:
+    std::vector< uint64_t > _bits;   //!< one bit per element
+    std::vector< uint64_t > _blocks; //!< one bit per non-zero word of _bits
+    size_t _size;
+};
+
+template< class T > inline
+void DirtyBitset::write( DataOStream& os, const std::vector< T >& data,
+                         const bool all ) const
+{
+    Ranges ranges;
+    if( all )
+    {
+        if( !data.empty( ))
+            ranges.push_back( Range( 0, data.size( )));
+    }
+    else
+    {
+        ranges = getRanges();
+        while( !ranges.empty() && ranges.back().first >= data.size( ))
+            ranges.pop_back();
+        if( !ranges.empty() && ranges.back().second > data.size( ))
+            ranges.back().second = data.size();
+    }
+
+    os << uint64_t( data.size( )) << uint64_t( ranges.size( ));
+    for( Ranges::const_iterator i = ranges.begin(); i != ranges.end(); ++i )
+    {
+        const uint64_t nElems = i->second - i->first;
+        os << uint64_t( i->first ) << nElems
+           << Array< const T >( &data[ i->first ], nElems );
+    }
+}
+
+template< class T > inline
+bool DirtyBitset::read( DataIStream& is, std::vector< T >& data )
+{
+    const uint64_t size = is.read< uint64_t >();
+    const uint64_t nRanges = is.read< uint64_t >();
+    data.resize( size );
+
+    for( uint64_t i = 0; i < nRanges; ++i )
+    {
+        const uint64_t first = is.read< uint64_t >();
+        const uint64_t nElems = is.read< uint64_t >();
+        if( first > size || nElems > size - first )
+        {
+            LBERROR << "Invalid element range [" << first << ", "
+                    << first + nElems << ") for array of size " << size
+                    << std::endl;
+            return false;
+        }
+        if( nElems > 0 )
+            is >> Array< T >( &data[ first ], nElems );
+    }
+    return true;
+}
+}
+
+#endif // CO_DIRTYBITSET_H
@@ -0,0 +1,238 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_FIELDS_H
+#define CO_FIELDS_H
+
+#include <co/dataIStream.h> // used inline
+#include <co/dataOStream.h> // used inline
+
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/seq/size.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_pod.hpp>
+
+namespace co
+{
+/**
+ * The serializable fields of a struct, declared using CO_FIELDS.
+ *
+ * For each field FOO, the specialization defines the dirty bit
+ * <code>Fields< S >::DIRTY_FOO</code>. DIRTY_FIELDS contains the bits of all
+ * fields.
+ */
+template< class S > class Fields;
+
+/** @internal */
+namespace detail
+{
+/** @internal Description of one field, generated by CO_FIELDS. */
+template< class S > struct Field
+{
+    void* (*get)( S& );                          //!< @return the field address
+    size_t size;                                 //!< sizeof the field
+    bool pod;                                    //!< copied as raw bytes
+    void (*write)( DataOStream&, const void* );  //!< write non-POD field
+    void (*read)( DataIStream&, void* );         //!< read non-POD field
+    void (*swap)( void* );                       //!< byte-swap POD field
+};
+
+template< class T > struct FieldIO
+{
+    static void write( DataOStream& os, const void* ptr )
+        { os << *static_cast< const T* >( ptr ); }
+    static void read( DataIStream& is, void* ptr )
+        { is >> *static_cast< T* >( ptr ); }
+    static void swap( void* ptr )
+        { DataIStream::swap( *static_cast< T* >( ptr )); }
+};
+
+/** C arrays are swapped per element */
+template< class T, size_t N > struct FieldIO< T[N] >
+{
+    static void write( DataOStream& os, const void* ptr )
+        { os << Array< const T >( static_cast< const T* >( ptr ), N ); }
+    static void read( DataIStream& is, void* ptr )
+        { is >> Array< T >( static_cast< T* >( ptr ), N ); }
+    static void swap( void* ptr )
+    {
+        for( size_t i = 0; i < N; ++i )
+            FieldIO< T >::swap( static_cast< T* >( ptr ) + i );
+    }
+};
+
+/** @return the end of the run of contiguous POD fields starting at first. */
+template< class S >
+size_t findRun( const Field< S >* fields, S& object, const size_t first,
+                const uint64_t dirty, size_t& nBytes )
+{
+    uint8_t* end = static_cast< uint8_t* >( fields[ first ].get( object ));
+    nBytes = 0;
+    size_t i = first;
+    for( ; i < Fields< S >::nFields; ++i )
+    {
+        const Field< S >& field = fields[i];
+        if( !field.pod || !( dirty & ( uint64_t( 1 ) << i )) ||
+            field.get( object ) != end )
+        {
+            break;
+        }
+        end += field.size;
+        nBytes += field.size;
+    }
+    return i;
+}
+}
+
+/**
+ * Write the fields of the given struct selected by the dirty bits.
+ *
+ * Contiguous runs of dirty POD fields without padding are written with a
+ * single copy. Other fields use their DataOStream operator.
+ * @version 1.1.1
+ */
+template< class S > inline
+void serializeFields( DataOStream& os, const S& object,
+                      const uint64_t dirty = Fields< S >::DIRTY_FIELDS )
+{
+    const detail::Field< S >* fields = Fields< S >::getFields();
+    S& data = const_cast< S& >( object );
+
+    for( size_t i = 0; i < Fields< S >::nFields; )
+    {
+        if( !( dirty & ( uint64_t( 1 ) << i )))
+        {
+            ++i;
+            continue;
+        }
+
+        const detail::Field< S >& field = fields[i];
+        if( !field.pod )
+        {
+            field.write( os, field.get( data ));
+            ++i;
+            continue;
+        }
+
+        size_t nBytes = 0;
+        const size_t end = detail::findRun( fields, data, i, dirty, nBytes );
+        os << Array< const uint8_t >(
+                  static_cast< const uint8_t* >( field.get( data )), nBytes );
+        i = end;
+    }
+}
+
+/**
+ * Read the fields written by serializeFields() with the same dirty bits.
+ * @version 1.1.1
+ */
+template< class S > inline
+void deserializeFields( DataIStream& is, S& object,
+                        const uint64_t dirty = Fields< S >::DIRTY_FIELDS )
+{
+    const detail::Field< S >* fields = Fields< S >::getFields();
+    const bool swapping = is.isSwapping();
+
+    for( size_t i = 0; i < Fields< S >::nFields; )
+    {
+        if( !( dirty & ( uint64_t( 1 ) << i )))
+        {
+            ++i;
+            continue;
+        }
+
+        const detail::Field< S >& field = fields[i];
+        if( !field.pod )
+        {
+            field.read( is, field.get( object ));
+            ++i;
+            continue;
+        }
+
+        size_t nBytes = 0;
+        const size_t end = detail::findRun( fields, object, i, dirty, nBytes );
+        is >> Array< uint8_t >( static_cast< uint8_t* >( field.get( object )),
+                                nBytes );
+        if( swapping )
+            for( size_t j = i; j < end; ++j )
+                fields[j].swap( fields[j].get( object ));
+        i = end;
+    }
+}
+}
+
+/** @cond IGNORE */
+#define CO_FIELD_GETTER( r, S, i, name )                                \
+    static void* BOOST_PP_CAT( _get_, name )( S& s ) { return &s.name; }
+
+#define CO_FIELD_BIT( r, S, i, name )                                   \
+    static const uint64_t BOOST_PP_CAT( DIRTY_, name ) = uint64_t( 1 ) << i;
+
+#define CO_FIELD_DESC( r, S, i, name )                              \
+    { &BOOST_PP_CAT( _get_, name ), sizeof( S::name ),              \
+      boost::is_pod< decltype( S::name ) >::value,                  \
+      &::co::detail::FieldIO< decltype( S::name ) >::write,         \
+      &::co::detail::FieldIO< decltype( S::name ) >::read,          \
+      &::co::detail::FieldIO< decltype( S::name ) >::swap },
+/** @endcond */
+
+/**
+ * Declare the serializable fields of a struct.
+ *
+ * Has to be used in the global namespace. The fields are given as a
+ * Boost.Preprocessor sequence in the order of their declaration, for example:
+ * @code
+ * struct Camera { float position[3]; float fov; std::string name; };
+ * CO_FIELDS( Camera, (position)(fov)(name) )
+ *
+ * void MyObject::serialize( co::DataOStream& os, const uint64_t dirty )
+ *     { co::serializeFields( os, _camera, dirty ); }
+ * void MyObject::deserialize( co::DataIStream& is, const uint64_t dirty )
+ *     { co::deserializeFields( is, _camera, dirty ); }
+ * @endcode
+ *
+ * Field i uses dirty bit 1 << i, which corresponds to Serializable::DIRTY_CUSTOM
+ * << i. Private fields require a <code>friend class co::Fields< S ></code>
+ * declaration.
+ * @version 1.1.1
+ */
+#define CO_FIELDS( S, FIELDS )                                          \
+    namespace co                                                        \
+    {                                                                   \
+    template<> class Fields< S >                                        \
+    {                                                                   \
+        BOOST_PP_SEQ_FOR_EACH_I( CO_FIELD_GETTER, S, FIELDS )           \
+    public:                                                             \
+        BOOST_PP_SEQ_FOR_EACH_I( CO_FIELD_BIT, S, FIELDS )              \
+        static const size_t nFields = BOOST_PP_SEQ_SIZE( FIELDS );      \
+        BOOST_STATIC_ASSERT( nFields <= 64 );                           \
+        static const uint64_t DIRTY_FIELDS =                            \
+            nFields == 64 ? ~uint64_t( 0 ) :                            \
+                            ( uint64_t( 1 ) << ( nFields % 64 )) - 1;   \
+        static const detail::Field< S >* getFields()                    \
+        {                                                               \
+            static const detail::Field< S > fields[] = {                \
+                BOOST_PP_SEQ_FOR_EACH_I( CO_FIELD_DESC, S, FIELDS ) };  \
+            return fields;                                              \
+        }                                                               \
+    };                                                                  \
+    }
+
+#endif // CO_FIELDS_H
@@ -12,6 +12,7 @@ set(COLLAGE_PUBLIC_HEADERS
   commandFunc.h
   commandQueue.h
   commands.h
+  completionGroup.h
   connection.h
   connectionDescription.h
   connectionSet.h
@@ -27,9 +28,11 @@ set(COLLAGE_PUBLIC_HEADERS
   dataOStreamArchive.h
   dataOStreamArchive.ipp
   dataStreamArchiveException.h
+  dirtyBitset.h
   dispatcher.h
   exception.h
   features.h
+  fields.h
   global.h
   iCommand.h
   init.h
@@ -58,11 +61,14 @@ set(COLLAGE_PUBLIC_HEADERS
 
 set(COLLAGE_HEADERS
   barrierCommand.h
+  binaryDelta.h
   bufferCache.h
+  bufferDataIStream.h
   connectionListener.h
   dataStreamArchive.h
   dataIStreamQueue.h
   deltaMasterCM.h
+  diffMasterCM.h
   eventConnection.h
   fullMasterCM.h
   instanceCache.h
@@ -81,6 +87,7 @@ set(COLLAGE_HEADERS
   pipeConnection.h
   queueCommand.h
   rspConnection.h
+  rspParity.h
   socketConnection.h
   staticMasterCM.h
   staticSlaveCM.h
@@ -92,10 +99,13 @@ set(COLLAGE_HEADERS
 set(COLLAGE_SOURCES
   ${COMMON_SOURCES}
   barrier.cpp
+  binaryDelta.cpp
   buffer.cpp
   bufferCache.cpp
   bufferConnection.cpp
+  bufferDataIStream.cpp
   commandQueue.cpp
+  completionGroup.cpp
   connection.cpp
   connectionDescription.cpp
   connectionSet.cpp
@@ -107,6 +117,8 @@ set(COLLAGE_SOURCES
   dataOStream.cpp
   dataOStreamArchive.cpp
   deltaMasterCM.cpp
+  diffMasterCM.cpp
+  dirtyBitset.cpp
   dispatcher.cpp
   eventConnection.cpp
   fullMasterCM.cpp
@@ -138,6 +150,7 @@ set(COLLAGE_SOURCES
   queueMaster.cpp
   queueSlave.cpp
   rspConnection.cpp
+  rspParity.cpp
   sendToken.cpp
   serializable.cpp
   socketConnection.cpp
@@ -153,8 +166,8 @@ if(WIN32)
   list(APPEND COLLAGE_HEADERS namedPipeConnection.h)
   list(APPEND COLLAGE_SOURCES namedPipeConnection.cpp)
 else()
-  list(APPEND COLLAGE_HEADERS fdConnection.h)
-  list(APPEND COLLAGE_SOURCES fdConnection.cpp)
+  list(APPEND COLLAGE_HEADERS fdConnection.h stripedConnection.h)
+  list(APPEND COLLAGE_SOURCES fdConnection.cpp stripedConnection.cpp)
 endif()
 
 if(OFED_FOUND)
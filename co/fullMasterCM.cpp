@@ -339,22 +339,32 @@ uint128_t FullMasterCM::commit( const uint32_t incarnation )
         return _version;
     }
 
-    _maxVersion.waitGE( _version.low() + 1 );
+    _waitCommitWindow();
     Mutex mutex( _slaves );
 #if 0
     LBLOG( LOG_OBJECTS ) << "commit v" << _version << " " << command
                          << std::endl;
 #endif
     _updateCommitCount( incarnation );
+    _updateReceivers();
     _commit();
+    _sendCatchUp();
     _obsolete();
     return _version;
 }
 
+void FullMasterCM::_sendHead( ObjectInstanceDataOStream& /*os*/,
+                              NodePtr node, const uint32_t instanceID,
+                              const bool /*first*/ )
+{
+    // resend the buffered head version, see VersionedMasterCM::_sendHead()
+    _getHeadInstanceData()->os.sendMapData( node, instanceID, false );
+}
+
 void FullMasterCM::_commit()
 {
     InstanceData* instanceData = _newInstanceData();
-    instanceData->os.enableCommit( _version + 1, *_slaves );
+    instanceData->os.enableCommit( _version + 1, _receivers );
     _object->getInstanceData( instanceData->os );
     instanceData->os.disable();
 
@@ -70,6 +70,7 @@ namespace co
                          bool ) override;
 
         InstanceData* _newInstanceData();
+        InstanceData* _getHeadInstanceData() { return _instanceDatas.back(); }
         void _addInstanceData( InstanceData* data );
         void _releaseInstanceData( InstanceData* data );
 
@@ -79,6 +80,8 @@ namespace co
 
         bool isBuffered() const override { return true; }
         virtual void _commit();
+        void _sendHead( ObjectInstanceDataOStream& os, NodePtr node,
+                        const uint32_t instanceID, const bool first ) override;
 
     private:
         /** The number of commits, needed for auto-obsoletion. */
@@ -95,6 +95,20 @@ int32_t     _iAttributes[Global::IATTR_ALL] =
     _getTimeout(), // IATTR_TIMEOUT_DEFAULT
     1023,   // IATTR_OBJECT_COMPRESSION
     0,      // IATTR_CMD_QUEUE_LIMIT
+    50,     // IATTR_BARRIER_SPIN_TIME
+    0,      // IATTR_OBJECT_COMMAND_THREADS
+    0,      // IATTR_NODE_CONTROL_CONNECTION
+    1,      // IATTR_COMMAND_COMPACT_FRAMING
+    0,      // IATTR_COMMAND_COALESCE_SIZE
+    1,      // IATTR_COMMAND_COALESCE_TIME
+    4,      // IATTR_TCP_STRIPES
+    65536,  // IATTR_TCP_STRIPE_UNIT
+    0,      // IATTR_RSP_PARITY_BLOCK
+    0,      // IATTR_RSP_RATE_CONTROL
+    64,     // IATTR_QUEUE_PREFETCH_MAX
+    0,      // IATTR_RSP_TEST_LOSS
+    100,    // IATTR_QUEUE_STEAL_TIMEOUT
+    0,      // IATTR_RSP_MULTICAST_LOOPBACK
 };
 }
 
@@ -102,6 +102,20 @@ namespace co
             IATTR_TIMEOUT_DEFAULT,       //!< @internal default timeout
             IATTR_OBJECT_COMPRESSION,    //!< @internal threshold to compress
             IATTR_CMD_QUEUE_LIMIT,     //!< @internal max cmd thread q size/1024
+            IATTR_BARRIER_SPIN_TIME,     //!< @internal spin time in us
+            IATTR_OBJECT_COMMAND_THREADS, //!< @internal object cmd workers
+            IATTR_NODE_CONTROL_CONNECTION, //!< @internal separate ctrl lane
+            IATTR_COMMAND_COMPACT_FRAMING, //!< @internal no cmd padding
+            IATTR_COMMAND_COALESCE_SIZE, //!< @internal small send buffer
+            IATTR_COMMAND_COALESCE_TIME, //!< @internal max send delay in ms
+            IATTR_TCP_STRIPES,           //!< @internal sockets per stripe conn
+            IATTR_TCP_STRIPE_UNIT,       //!< @internal bytes per stripe unit
+            IATTR_RSP_PARITY_BLOCK,      //!< @internal datagrams per parity
+            IATTR_RSP_RATE_CONTROL,      //!< @internal 0: loss, 1: readers
+            IATTR_QUEUE_PREFETCH_MAX,    //!< @internal adaptive prefetch max
+            IATTR_RSP_TEST_LOSS,         //!< @internal drop every nth datagram
+            IATTR_QUEUE_STEAL_TIMEOUT,   //!< @internal steal reply wait in ms
+            IATTR_RSP_MULTICAST_LOOPBACK, //!< @internal deliver to own host
             IATTR_ALL
         };
 
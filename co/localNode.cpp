@@ -66,6 +66,7 @@ lunchbox::a_int32_t _threadIDs;
 
 typedef CommandFunc< LocalNode > CmdFunc;
 typedef std::list< ICommand > CommandList;
+typedef stde::hash_map< uint128_t, CommandList > CommandListHash;
 typedef lunchbox::RefPtrHash< Connection, NodePtr > ConnectionNodeHash;
 typedef ConnectionNodeHash::const_iterator ConnectionNodeHashCIter;
 typedef ConnectionNodeHash::iterator ConnectionNodeHashIter;
@@ -125,6 +126,38 @@ private:
     co::LocalNode* const _localNode;
 };
 
+/** Executes the commands of a subset of all objects, in order. */
+class ObjectCommandThread : public Worker
+{
+public:
+    ObjectCommandThread( const int32_t threadID, const size_t index )
+        : Worker( Global::getCommandQueueLimit( ))
+        , _stopped( false )
+        , _name( std::string( "Cmd" ) +
+                 boost::lexical_cast< std::string >( threadID ) + "." +
+                 boost::lexical_cast< std::string >( index ))
+    {}
+
+    /** Exit after the current command, called from this thread. */
+    void stop() { _stopped = true; }
+
+protected:
+    bool init() override
+    {
+        setName( _name );
+        return true;
+    }
+
+    // exit only on the stop command queued last, not on close, to execute
+    // all commands queued before it
+    bool stopRunning() override { return _stopped; }
+
+private:
+    bool _stopped;
+    const std::string _name;
+};
+typedef std::vector< ObjectCommandThread* > ObjectCommandThreads;
+
 class LocalNode
 {
 public:
@@ -144,6 +177,7 @@ public:
         LBASSERT( incoming.isEmpty( ));
         LBASSERT( connectionNodes.empty( ));
         LBASSERT( pendingCommands.empty( ));
+        LBASSERT( pendingObjectCommands.empty( ));
         LBASSERT( nodes->empty( ));
 
         delete objectStore;
@@ -152,6 +186,13 @@ public:
         delete commandThread;
         commandThread = 0;
 
+        for( size_t i = 0; i < objectCommandThreads.size(); ++i )
+        {
+            LBASSERT( !objectCommandThreads[i]->isRunning( ));
+            delete objectCommandThreads[i];
+        }
+        objectCommandThreads.clear();
+
         LBASSERT( !receiverThread->isRunning( ));
         delete receiverThread;
         receiverThread = 0;
@@ -159,9 +200,34 @@ public:
 
     bool inReceiverThread() const { return receiverThread->isCurrent(); }
 
-    /** Commands re-scheduled for dispatch. */
+    /** @return the number of commands re-scheduled for dispatch. */
+    size_t getNumPendingCommands() const
+    {
+        size_t size = pendingCommands.size();
+        for( CommandListHash::const_iterator i = pendingObjectCommands.begin();
+             i != pendingObjectCommands.end(); ++i )
+        {
+            size += i->second.size();
+        }
+        return size;
+    }
+
+    void clearPendingCommands()
+    {
+        pendingCommands.clear();
+        pendingObjectCommands.clear();
+        attachedObjects.clear();
+    }
+
+    /** Non-object commands re-scheduled for dispatch. */
     CommandList  pendingCommands;
 
+    /** Object commands re-scheduled for dispatch, by object identifier. */
+    CommandListHash pendingObjectCommands;
+
+    /** Objects with pending commands attached since the last redispatch. */
+    std::vector< uint128_t > attachedObjects;
+
     /** The command buffer 'allocator' for small packets */
     co::BufferCache smallBuffers;
 
@@ -199,6 +265,9 @@ public:
     ReceiverThread* receiverThread;
     CommandThread* commandThread;
 
+    /** Optional pool executing object commands, hashed by object ID. */
+    ObjectCommandThreads objectCommandThreads;
+
     lunchbox::Lockable< lunchbox::Servus > service;
 
     // Performance counters:
@@ -225,6 +294,12 @@ LocalNode::LocalNode( const uint32_t type )
                      CmdFunc( this, &LocalNode::_cmdConnectReply ), 0 );
     registerCommand( CMD_NODE_ID,
                      CmdFunc( this, &LocalNode::_cmdID ), 0 );
+    registerCommand( CMD_NODE_CONTROL_CONNECTION,
+                     CmdFunc( this, &LocalNode::_cmdControlConnection ), 0 );
+    registerCommand( CMD_NODE_CONTROL_CONNECTION_BE,
+                     CmdFunc( this, &LocalNode::_cmdControlConnection ), 0 );
+    registerCommand( CMD_NODE_CONNECT_CONTROL,
+                     CmdFunc( this, &LocalNode::_cmdConnectControl ), queue );
     registerCommand( CMD_NODE_ID_BE,
                      CmdFunc( this, &LocalNode::_cmdID ), 0 );
     registerCommand( CMD_NODE_ACK_REQUEST,
@@ -486,12 +561,13 @@ void LocalNode::_addConnection( ConnectionPtr connection )
     if( _impl->receiverThread->isRunning() && !_impl->inReceiverThread( ))
     {
         connection->ref(); // unref in _cmdAddConnection
-        send( CMD_NODE_ADD_CONNECTION ) << (uint64_t)(connection.get( ));
+        send( CMD_NODE_ADD_CONNECTION ) << (uint64_t)(connection.get( ))
+                                        << static_cast< Node* >( 0 );
         return;
     }
 
     BufferPtr buffer = _impl->smallBuffers.alloc( COMMAND_ALLOCSIZE );
-    connection->recvNB( buffer, COMMAND_MINSIZE );
+    connection->recvNB( buffer, connection->getHeaderReceiveSize( ));
     _impl->incoming.addConnection( connection );
 }
 
@@ -543,6 +619,7 @@ void LocalNode::_closeNode( NodePtr node )
 {
     ConnectionPtr connection = node->getConnection();
     ConnectionPtr mcConnection = node->_getMulticast();
+    ConnectionPtr ctlConnection = node->_getControl();
 
     node->_disconnect();
 
@@ -561,6 +638,12 @@ void LocalNode::_closeNode( NodePtr node )
         _impl->connectionNodes.erase( mcConnection );
     }
 
+    if( ctlConnection )
+    {
+        _removeConnection( ctlConnection );
+        _impl->connectionNodes.erase( ctlConnection );
+    }
+
     _impl->objectStore->removeInstanceData( node->getNodeID( ));
 
     lunchbox::ScopedFastWrite mutex( _impl->nodes );
@@ -580,7 +663,13 @@ bool LocalNode::_connectSelf()
         return false;
     }
 
-    Node::_connect( connection->acceptSync( ));
+    ConnectionPtr sibling = connection->acceptSync();
+    const bool compact =
+        Global::getIAttribute( Global::IATTR_COMMAND_COMPACT_FRAMING ) > 0;
+    sibling->setCompactSend( compact );
+    connection->setCompactReceive( compact );
+
+    Node::_connect( sibling );
     _setClosed(); // reset state after _connect set it to connected
 
     // add to connection set
@@ -628,7 +717,7 @@ void LocalNode::ackRequest( NodePtr node, const uint32_t requestID )
 void LocalNode::ping( NodePtr peer )
 {
     LBASSERT( !_impl->inReceiverThread( ));
-    peer->send( CMD_NODE_PING );
+    OCommand( Connections( 1, peer->getControlConnection( )), CMD_NODE_PING );
 }
 
 bool LocalNode::pingIdleNodes()
@@ -646,7 +735,8 @@ bool LocalNode::pingIdleNodes()
         {
             LBINFO << " Ping Node: " <<  node->getNodeID() << " last seen "
                    << node->getLastReceiveTime() << std::endl;
-            node->send( CMD_NODE_PING );
+            OCommand( Connections( 1, node->getControlConnection( )),
+                      CMD_NODE_PING );
             pinged = true;
         }
     }
@@ -696,6 +786,18 @@ f_bool_t LocalNode::mapObject( Object* object, const UUID& id, NodePtr master,
     return f_bool_t( new FuturebImpl( func ));
 }
 
+void LocalNode::mapObject( Object* object, const UUID& id, NodePtr master,
+                           const uint128_t& version,
+                           const CompletionHandler& handler )
+{
+    LBASSERT( handler );
+    if( _impl->objectStore->mapNB( object, id, version, master, handler ) ==
+        LB_UNDEFINED_UINT32 )
+    {
+        handler( false );
+    }
+}
+
 uint32_t LocalNode::mapObjectNB( Object* object, const UUID& id,
                                  const uint128_t& version )
 {
@@ -720,6 +822,13 @@ f_bool_t LocalNode::syncObject( Object* object, NodePtr master, const UUID& id,
     return _impl->objectStore->sync( object, master, id, instanceID );
 }
 
+void LocalNode::syncObject( Object* object, NodePtr master, const UUID& id,
+                            const uint32_t instanceID,
+                            const CompletionHandler& handler )
+{
+    _impl->objectStore->sync( object, master, id, instanceID, handler );
+}
+
 void LocalNode::unmapObject( Object* object )
 {
     _impl->objectStore->unmap( object );
@@ -1054,8 +1163,10 @@ uint32_t LocalNode::_connect( NodePtr node, ConnectionPtr connection )
 #else
     const uint32_t cmd = CMD_NODE_CONNECT;
 #endif
+    const bool compact =
+        Global::getIAttribute( Global::IATTR_COMMAND_COMPACT_FRAMING ) > 0;
     OCommand( Connections( 1, connection ), cmd )
-        << getNodeID() << request << getType() << serialize();
+        << getNodeID() << request << getType() << serialize() << compact;
 
     bool connected = false;
     try
@@ -1137,6 +1248,17 @@ CommandQueue* LocalNode::getCommandThreadQueue()
     return _impl->commandThread->getWorkerQueue();
 }
 
+CommandQueue* LocalNode::getCommandThreadQueue( const uint128_t& id )
+{
+    const detail::ObjectCommandThreads& threads =
+        _impl->objectCommandThreads;
+    if( threads.empty( ))
+        return getCommandThreadQueue();
+
+    const size_t index = size_t( id.high() ^ id.low( )) % threads.size();
+    return threads[ index ]->getWorkerQueue();
+}
+
 bool LocalNode::inCommandThread() const
 {
     return _impl->commandThread->isCurrent();
@@ -1154,9 +1276,23 @@ ssize_t LocalNode::getCounter( const Counter counter ) const
 
 void LocalNode::flushCommands()
 {
+    _flushConnections();
     _impl->incoming.interrupt();
 }
 
+void LocalNode::_flushConnections()
+{
+    Nodes nodes;
+    getNodes( nodes, false );
+
+    for( NodesCIter i = nodes.begin(); i != nodes.end(); ++i )
+    {
+        ConnectionPtr connection = (*i)->getConnection();
+        if( connection )
+            connection->flush();
+    }
+}
+
 //----------------------------------------------------------------------
 // receiver thread functions
 //----------------------------------------------------------------------
@@ -1165,10 +1301,25 @@ void LocalNode::_runReceiverThread()
     LB_TS_THREAD( _rcvThread );
     _initService();
 
+    // coalesced commands are written at least every coalesce time
+    const uint32_t flushTime =
+        Global::getIAttribute( Global::IATTR_COMMAND_COALESCE_SIZE ) > 0 ?
+        uint32_t( std::max( 1, Global::getIAttribute(
+                                Global::IATTR_COMMAND_COALESCE_TIME ))) :
+        LB_TIMEOUT_INDEFINITE;
+    int64_t nextFlush = getTime64() + flushTime;
+
     int nErrors = 0;
     while( isListening( ))
     {
-        const ConnectionSet::Event result = _impl->incoming.select();
+        const ConnectionSet::Event result =
+            _impl->incoming.select( flushTime );
+        if( flushTime != LB_TIMEOUT_INDEFINITE && getTime64() >= nextFlush )
+        {
+            _flushConnections();
+            nextFlush = getTime64() + flushTime;
+        }
+
         switch( result )
         {
             case ConnectionSet::EVENT_CONNECT:
@@ -1185,7 +1336,8 @@ void LocalNode::_runReceiverThread()
                 break;
 
             case ConnectionSet::EVENT_TIMEOUT:
-                LBINFO << "select timeout" << std::endl;
+                if( flushTime == LB_TIMEOUT_INDEFINITE )
+                    LBINFO << "select timeout" << std::endl;
                 break;
 
             case ConnectionSet::EVENT_ERROR:
@@ -1210,7 +1362,7 @@ void LocalNode::_runReceiverThread()
                 break;
 
             case ConnectionSet::EVENT_INTERRUPT:
-                _redispatchCommands();
+                _flushPendingCommands();
                 break;
 
             default:
@@ -1222,12 +1374,15 @@ void LocalNode::_runReceiverThread()
             nErrors = 0;
     }
 
-    if( !_impl->pendingCommands.empty( ))
-        LBWARN << _impl->pendingCommands.size()
-               << " commands pending while leaving command thread" << std::endl;
+    const size_t nPending = _impl->getNumPendingCommands();
+    if( nPending > 0 )
+        LBWARN << nPending << " commands pending while leaving command thread"
+               << std::endl;
 
-    _impl->pendingCommands.clear();
+    _impl->clearPendingCommands();
     LBCHECK( _impl->commandThread->join( ));
+    for( size_t i = 0; i < _impl->objectCommandThreads.size(); ++i )
+        LBCHECK( _impl->objectCommandThreads[i]->join( ));
 
     ConnectionPtr connection = getConnection();
     PipeConnectionPtr pipe = LBSAFECAST( PipeConnection*, connection.get( ));
@@ -1248,7 +1403,7 @@ void LocalNode::_runReceiverThread()
     }
 
     _impl->objectStore->clear();
-    _impl->pendingCommands.clear();
+    _impl->clearPendingCommands();
     _impl->smallBuffers.flush();
     _impl->bigBuffers.flush();
 
@@ -1279,16 +1434,25 @@ void LocalNode::_handleDisconnect()
     {
         NodePtr node = i->second;
 
-        node->ref(); // extend lifetime to give cmd handler a chance
+        if( node->_getControl() == connection )
+        {
+            // fall back to primary connection, the node stays connected
+            node->_setControl( 0 );
+            _impl->connectionNodes.erase( i );
+        }
+        else
+        {
+            node->ref(); // extend lifetime to give cmd handler a chance
 
-        // local command dispatching
-        OCommand( this, this, CMD_NODE_REMOVE_NODE )
-                << node.get() << uint32_t( LB_UNDEFINED_UINT32 );
+            // local command dispatching
+            OCommand( this, this, CMD_NODE_REMOVE_NODE )
+                    << node.get() << uint32_t( LB_UNDEFINED_UINT32 );
 
-        if( node->getConnection() == connection )
-            _closeNode( node );
-        else
-            node->_removeMulticast( connection );
+            if( node->getConnection() == connection )
+                _closeNode( node );
+            else
+                node->_removeMulticast( connection );
+        }
     }
 
     _removeConnection( connection );
@@ -1310,16 +1474,20 @@ bool LocalNode::_handleData()
     const bool gotCommand = _readTail( command, buffer, connection );
     LBASSERT( gotCommand );
 
-    // start next receive
-    BufferPtr nextBuffer = _impl->smallBuffers.alloc( COMMAND_ALLOCSIZE );
-    connection->recvNB( nextBuffer, COMMAND_MINSIZE );
-
     if( gotCommand )
-    {
         _dispatchCommand( command );
-        return true;
+
+    // start next receive after dispatch, the connection handshake may change
+    // the framing of subsequent commands
+    if( !connection->isClosed( ))
+    {
+        BufferPtr nextBuffer = _impl->smallBuffers.alloc( COMMAND_ALLOCSIZE );
+        connection->recvNB( nextBuffer, connection->getHeaderReceiveSize( ));
     }
 
+    if( gotCommand )
+        return true;
+
     LBERROR << "Incomplete command read: " << command << std::endl;
     return false;
 }
@@ -1342,7 +1510,7 @@ BufferPtr LocalNode::_readHead( ConnectionPtr connection )
 
     // Some systems signal data on dead connections.
     buffer->setSize( 0 );
-    connection->recvNB( buffer, COMMAND_MINSIZE );
+    connection->recvNB( buffer, connection->getHeaderReceiveSize( ));
     return 0;
 }
 
@@ -1355,6 +1523,7 @@ ICommand LocalNode::_setupCommand( ConnectionPtr connection,
         node = i->second;
     LBASSERTINFO( !node || // unconnected node
                   *(node->getConnection()) == *connection || // correct UC conn
+                  node->_getControl() == connection || // control connection
                   connection->isMulticast(), lunchbox::className( node ));
     LBVERB << "Handle data from " << node << std::endl;
 
@@ -1380,6 +1549,7 @@ ICommand LocalNode::_setupCommand( ConnectionPtr connection,
     case CMD_NODE_CONNECT:
     case CMD_NODE_CONNECT_REPLY:
     case CMD_NODE_ID:
+    case CMD_NODE_CONTROL_CONNECTION:
 #ifdef COLLAGE_BIGENDIAN
         command = ICommand( this, node, buffer, true );
 #endif
@@ -1388,6 +1558,7 @@ ICommand LocalNode::_setupCommand( ConnectionPtr connection,
     case CMD_NODE_CONNECT_BE:
     case CMD_NODE_CONNECT_REPLY_BE:
     case CMD_NODE_ID_BE:
+    case CMD_NODE_CONTROL_CONNECTION_BE:
 #ifndef COLLAGE_BIGENDIAN
         command = ICommand( this, node, buffer, true );
 #endif
@@ -1443,11 +1614,15 @@ void LocalNode::_dispatchCommand( ICommand& command )
 
     if( dispatchCommand( command ))
         _redispatchCommands();
-    else
+    else if( command.getType() == COMMANDTYPE_OBJECT )
     {
-        _redispatchCommands();
-        _impl->pendingCommands.push_back( command );
+        // queue until the object is attached, see _objectAttached()
+        const ObjectICommand objectCommand( command );
+        _impl->pendingObjectCommands[ objectCommand.getObjectID( )].push_back(
+            command );
     }
+    else
+        _impl->pendingCommands.push_back( command );
 }
 
 bool LocalNode::dispatchCommand( ICommand& command )
@@ -1471,33 +1646,75 @@ bool LocalNode::dispatchCommand( ICommand& command )
     }
 }
 
+void LocalNode::_objectAttached( const UUID& id )
+{
+    LB_TS_THREAD( _rcvThread );
+    if( _impl->pendingObjectCommands.find( id ) !=
+        _impl->pendingObjectCommands.end( ))
+    {
+        _impl->attachedObjects.push_back( id );
+    }
+}
+
+void LocalNode::_flushPendingCommands()
+{
+    for( CommandListHash::const_iterator i =
+             _impl->pendingObjectCommands.begin();
+         i != _impl->pendingObjectCommands.end(); ++i )
+    {
+        _impl->attachedObjects.push_back( i->first );
+    }
+    _redispatchCommands();
+}
+
 void LocalNode::_redispatchCommands()
 {
-    bool changes = true;
-    while( changes && !_impl->pendingCommands.empty( ))
+    // Custom commands wait for unknown conditions, retry them each time
+    for( CommandList::iterator i = _impl->pendingCommands.begin();
+         i != _impl->pendingCommands.end(); )
+    {
+        ICommand& command = *i;
+        LBASSERT( command.isValid( ));
+
+        if( dispatchCommand( command ))
+            i = _impl->pendingCommands.erase( i );
+        else
+            ++i;
+    }
+
+    // Object commands are only retried once their object has been attached.
+    // Dispatching them may attach further objects, which are appended.
+    while( !_impl->attachedObjects.empty( ))
     {
-        changes = false;
+        const uint128_t id = _impl->attachedObjects.back();
+        _impl->attachedObjects.pop_back();
+
+        CommandListHash::iterator i = _impl->pendingObjectCommands.find( id );
+        if( i == _impl->pendingObjectCommands.end( ))
+            continue;
 
-        for( CommandList::iterator i = _impl->pendingCommands.begin();
-             i != _impl->pendingCommands.end(); ++i )
+        CommandList commands;
+        commands.swap( i->second );
+        _impl->pendingObjectCommands.erase( i );
+
+        for( CommandList::iterator j = commands.begin(); j != commands.end();
+             ++j )
         {
-            ICommand& command = *i;
+            ICommand& command = *j;
             LBASSERT( command.isValid( ));
 
-            if( dispatchCommand( command ))
-            {
-                _impl->pendingCommands.erase( i );
-                changes = true;
-                break;
-            }
+            if( !dispatchCommand( command ))
+                _impl->pendingObjectCommands[ id ].push_back( command );
         }
     }
 
 #ifndef NDEBUG
-    if( !_impl->pendingCommands.empty( ))
-        LBVERB << _impl->pendingCommands.size() << " undispatched commands"
+    if( !_impl->pendingCommands.empty() ||
+        !_impl->pendingObjectCommands.empty( ))
+    {
+        LBVERB << _impl->getNumPendingCommands() << " undispatched commands"
                << std::endl;
-    LBASSERT( _impl->pendingCommands.size() < 200 );
+    }
 #endif
 }
 
@@ -1548,7 +1765,20 @@ Zeroconf LocalNode::getZeroconf()
 bool LocalNode::_startCommandThread( const int32_t threadID )
 {
     _impl->commandThread->threadID = threadID;
-    return _impl->commandThread->start();
+    if( !_impl->commandThread->start( ))
+        return false;
+
+    const int32_t nThreads =
+        Global::getIAttribute( Global::IATTR_OBJECT_COMMAND_THREADS );
+    for( int32_t i = 0; i < nThreads; ++i )
+    {
+        detail::ObjectCommandThread* thread =
+            new detail::ObjectCommandThread( threadID, i );
+        _impl->objectCommandThreads.push_back( thread );
+        if( !thread->start( ))
+            return false;
+    }
+    return true;
 }
 
 bool LocalNode::_notifyCommandThreadIdle()
@@ -1575,6 +1805,16 @@ bool LocalNode::_cmdStopRcv( ICommand& command )
 
     command.setCommand( CMD_NODE_STOP_CMD ); // causes cmd thread exit
     _dispatchCommand( command );
+
+    // object command threads exit after their queued commands
+    const detail::ObjectCommandThreads& threads = _impl->objectCommandThreads;
+    for( size_t i = 0; i < threads.size(); ++i )
+    {
+        ICommand stopCommand( command );
+        stopCommand.setDispatchFunction(
+            CmdFunc( this, &LocalNode::_cmdStopObjectCmd ));
+        threads[i]->getWorkerQueue()->push( stopCommand );
+    }
     return true;
 }
 
@@ -1587,6 +1827,22 @@ bool LocalNode::_cmdStopCmd( ICommand& )
     return true;
 }
 
+bool LocalNode::_cmdStopObjectCmd( ICommand& )
+{
+    LBASSERTINFO( isClosing() || isClosed(), *this );
+    const detail::ObjectCommandThreads& threads = _impl->objectCommandThreads;
+    for( size_t i = 0; i < threads.size(); ++i )
+    {
+        if( threads[i]->isCurrent( ))
+        {
+            threads[i]->stop();
+            return true;
+        }
+    }
+    LBUNREACHABLE;
+    return true;
+}
+
 bool LocalNode::_cmdSetAffinity( ICommand& command )
 {
     const int32_t affinity = command.get< int32_t >();
@@ -1668,6 +1924,20 @@ bool LocalNode::_cmdConnect( ICommand& command )
                   peer->getNodeID() << "!=" << nodeID );
     LBASSERT( peer->getType() == nodeType );
 
+    // old peers do not send their framing capability
+    const bool compact = command.getRemainingBufferSize() > 0 &&
+                         command.get< bool >() &&
+        Global::getIAttribute( Global::IATTR_COMMAND_COMPACT_FRAMING ) > 0;
+
+    // send our information as reply, before the connection is visible to
+    // other threads which might send commands with the old framing
+    OCommand( Connections( 1, connection ), cmd )
+        << getNodeID() << requestID << getType() << serialize() << compact;
+    connection->setCompactSend( compact );
+    connection->setCompactReceive( compact );
+    connection->setCoalescing( std::max( 0, Global::getIAttribute(
+                                   Global::IATTR_COMMAND_COALESCE_SIZE )));
+
     peer->_connect( connection );
     _impl->connectionNodes[ connection ] = peer;
     {
@@ -1676,10 +1946,6 @@ bool LocalNode::_cmdConnect( ICommand& command )
     }
     LBVERB << "Added node " << nodeID << std::endl;
 
-    // send our information as reply
-    OCommand( Connections( 1, connection ), cmd )
-        << getNodeID() << requestID << getType() << serialize();
-
     notifyConnect( peer );
     return true;
 }
@@ -1759,6 +2025,14 @@ bool LocalNode::_cmdConnectReply( ICommand& command )
     LBASSERT( data.empty( ));
     LBASSERT( peer->getNodeID() == nodeID );
 
+    // old peers do not reply with the negotiated framing
+    const bool compact = command.getRemainingBufferSize() > 0 &&
+                         command.get< bool >();
+    connection->setCompactSend( compact );
+    connection->setCompactReceive( compact );
+    connection->setCoalescing( std::max( 0, Global::getIAttribute(
+                                   Global::IATTR_COMMAND_COALESCE_SIZE )));
+
     peer->_connect( connection );
     _impl->connectionNodes[ connection ] = peer;
     {
@@ -1771,6 +2045,12 @@ bool LocalNode::_cmdConnectReply( ICommand& command )
 
     peer->send( CMD_NODE_CONNECT_ACK );
     _connectMulticast( peer );
+    if( Global::getIAttribute( Global::IATTR_NODE_CONTROL_CONNECTION ) > 0 )
+    {
+        // connect from the command thread, not to stall the receiver
+        peer->ref(); // unref in _cmdConnectControl
+        send( CMD_NODE_CONNECT_CONTROL ) << peer.get();
+    }
     notifyConnect( peer );
     return true;
 }
@@ -1846,6 +2126,83 @@ bool LocalNode::_cmdID( ICommand& command )
     return true;
 }
 
+bool LocalNode::_cmdConnectControl( ICommand& command )
+{
+    Node* node = command.get< Node* >();
+    NodePtr peer = node;
+    node->unref(); // ref'd in _cmdConnectReply
+
+    ConnectionPtr connection = peer->getConnection();
+    if( !connection || !peer->isConnected( ))
+        return true;
+
+    // Only stream sockets are cheap and safe to open for each peer
+    ConnectionDescriptionPtr description =
+        new ConnectionDescription( *connection->getDescription( ));
+    if( description->type != CONNECTIONTYPE_TCPIP )
+        return true;
+
+    ConnectionPtr control = Connection::create( description );
+    if( !control || !control->connect( ))
+    {
+        LBWARN << "Can't establish control connection to " << peer
+               << ", using primary connection" << std::endl;
+        return true;
+    }
+
+    // use the framing negotiated for the primary connection
+    const bool compact = connection->isCompactSend();
+    control->setCompactReceive( compact );
+
+#ifdef COLLAGE_BIGENDIAN
+    uint32_t cmd = CMD_NODE_CONTROL_CONNECTION_BE;
+    lunchbox::byteswap( cmd );
+#else
+    const uint32_t cmd = CMD_NODE_CONTROL_CONNECTION;
+#endif
+    OCommand( Connections( 1, control ), cmd ) << getNodeID() << compact;
+    control->setCompactSend( compact );
+
+    // the receiver thread adds and publishes it after the handshake
+    control->ref(); // unref in _cmdAddConnection
+    peer->ref();
+    send( CMD_NODE_ADD_CONNECTION ) << (uint64_t)(control.get( ))
+                                    << peer.get();
+    return true;
+}
+
+bool LocalNode::_cmdControlConnection( ICommand& command )
+{
+    LBASSERT( _impl->inReceiverThread( ));
+    LBASSERTINFO( !command.getNode(), command );
+
+    const NodeID& nodeID = command.get< NodeID >();
+    const bool compact = command.get< bool >();
+    ConnectionPtr connection = _impl->incoming.getConnection();
+    LBASSERT( _impl->connectionNodes.find( connection ) ==
+              _impl->connectionNodes.end( ));
+
+    // No locking needed, only recv thread modifies
+    NodeHashCIter i = _impl->nodes->find( nodeID );
+    if( i == _impl->nodes->end() || !i->second->isConnected() ||
+        i->second->_getControl( ))
+    {
+        LBWARN << "Refusing control connection from unknown node " << nodeID
+               << std::endl;
+        _removeConnection( connection );
+        return true;
+    }
+
+    NodePtr peer = i->second;
+    connection->setCompactSend( compact );
+    connection->setCompactReceive( compact );
+    peer->_setControl( connection );
+    _impl->connectionNodes[ connection ] = peer;
+    LBVERB << "Added control connection " << connection << " from " << peer
+           << std::endl;
+    return true;
+}
+
 bool LocalNode::_cmdDisconnect( ICommand& command )
 {
     LBASSERT( _impl->inReceiverThread( ));
@@ -2047,7 +2404,8 @@ bool LocalNode::_cmdRemoveListener( ICommand& command )
 bool LocalNode::_cmdPing( ICommand& command )
 {
     LBASSERT( inCommandThread( ));
-    command.getNode()->send( CMD_NODE_PING_REPLY );
+    OCommand( Connections( 1, command.getNode()->getControlConnection( )),
+              CMD_NODE_PING_REPLY );
     return true;
 }
 
@@ -2103,7 +2461,27 @@ bool LocalNode::_cmdAddConnection( ICommand& command )
     ConnectionPtr connection = rawConnection;
     connection->unref();
 
+    Node* node = command.get< Node* >();
+    if( !node )
+    {
+        _addConnection( connection );
+        return true;
+    }
+
+    // control connection established by _cmdConnectControl
+    NodePtr peer = node;
+    node->unref();
+    if( !peer->isConnected() || peer->_getControl( ))
+    {
+        connection->close();
+        return true;
+    }
+
     _addConnection( connection );
+    _impl->connectionNodes[ connection ] = peer;
+    peer->_setControl( connection );
+    LBVERB << "Added control connection " << connection << " to " << peer
+           << std::endl;
     return true;
 }
 
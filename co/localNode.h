@@ -261,6 +261,38 @@ public:
                        const uint128_t& version = VERSION_OLDEST )
         { return mapObject( object, id, 0, version ); }
 
+    /** Function signature for completion handlers. @version 1.1.1 */
+    typedef boost::function< void( bool ) > CompletionHandler;
+
+    /**
+     * Map a distributed object asynchronously.
+     *
+     * Behaves like mapObject() above, but instead of returning a future, the
+     * mapping is finalized on the command thread once the master has
+     * replied. The given handler is then called on the command thread with
+     * the success status. If the mapping can not be started, the handler is
+     * called immediately from the calling thread. If the master node
+     * disconnects before replying, the handler is called with false.
+     *
+     * applyMapData() and the handler run on the command thread, which also
+     * finalizes all other asynchronous operations. They must not block, and
+     * in particular must not map or synchronize other objects synchronously,
+     * since this deadlocks the command thread.
+     *
+     * This allows to drive a large number of concurrent mappings from a
+     * single thread, e.g., together with a CompletionGroup.
+     *
+     * @param object the object.
+     * @param id the master object identifier.
+     * @param master the node with the master instance, may be 0.
+     * @param version the initial version.
+     * @param handler the function called with the result of the operation.
+     * @version 1.1.1
+     */
+    CO_API void mapObject( Object* object, const UUID& id, NodePtr master,
+                           const uint128_t& version,
+                           const CompletionHandler& handler );
+
     /** @deprecated use mapObject() */
     CO_API uint32_t mapObjectNB( Object* object, const UUID& id,
                                  const uint128_t& version = VERSION_OLDEST);
@@ -296,6 +328,30 @@ public:
     CO_API f_bool_t syncObject( Object* object, NodePtr master,
                                 const UUID& id,
                                 const uint32_t instanceID = CO_INSTANCE_ALL );
+
+    /**
+     * Synchronize the local object with a remote object asynchronously.
+     *
+     * Behaves like syncObject() above, but applyInstanceData() and the given
+     * handler are called on the command thread once the data has been
+     * received. If the synchronization can not be started, the handler is
+     * called immediately from the calling thread. If the master node
+     * disconnects before replying, the handler is called with false. The
+     * same restrictions as for the asynchronous mapObject() apply: neither
+     * applyInstanceData() nor the handler may map or synchronize objects
+     * synchronously.
+     *
+     * @param object The local object instance to synchronize.
+     * @param master The node where the synchronizing object is attached.
+     * @param id the object identifier.
+     * @param instanceID the instance identifier of the synchronizing
+     *                   object.
+     * @param handler the function called with the result of the operation.
+     * @version 1.1.1
+     */
+    CO_API void syncObject( Object* object, NodePtr master, const UUID& id,
+                            const uint32_t instanceID,
+                            const CompletionHandler& handler );
     /**
      * Unmap a mapped object.
      *
@@ -421,6 +477,21 @@ public:
     /** Return the command queue to the command thread. @version 1.0 */
     CO_API CommandQueue* getCommandThreadQueue();
 
+    /**
+     * Return the command queue for the commands of the given object.
+     *
+     * If Global::IATTR_OBJECT_COMMAND_THREADS is set, object commands are
+     * distributed by identifier onto a pool of ordered command threads. All
+     * commands of one object execute in order on the same thread, while
+     * commands of unrelated objects execute concurrently. Otherwise this
+     * returns the queue of the command thread.
+     *
+     * @param id the identifier of the object.
+     * @return the command queue to execute the object's commands.
+     * @version 1.1.1
+     */
+    CO_API CommandQueue* getCommandThreadQueue( const uint128_t& id );
+
     /**
      * @return true if executed from the command handler thread, false if
      *         not.
@@ -450,7 +521,8 @@ public:
      * Flush all pending commands on this listening node.
      *
      * This causes the receiver thread to redispatch all pending commands,
-     * which are normally only redispatched when a new command is received.
+     * which are normally only redispatched when a new command is received,
+     * and writes all coalesced commands to the connected nodes.
      */
     CO_API void flushCommands();
 
@@ -585,16 +657,22 @@ private:
 
     void _dispatchCommand( ICommand& command );
     void   _redispatchCommands();
+    void   _flushPendingCommands();
+    void   _flushConnections();
+    void _objectAttached( const UUID& id );
 
     /** The command functions. */
     bool _cmdAckRequest( ICommand& command );
     bool _cmdStopRcv( ICommand& command );
     bool _cmdStopCmd( ICommand& command );
+    bool _cmdStopObjectCmd( ICommand& command );
     bool _cmdSetAffinity( ICommand& command );
     bool _cmdConnect( ICommand& command );
     bool _cmdConnectReply( ICommand& command );
     bool _cmdConnectAck( ICommand& command );
     bool _cmdID( ICommand& command );
+    bool _cmdControlConnection( ICommand& command );
+    bool _cmdConnectControl( ICommand& command );
     bool _cmdDisconnect( ICommand& command );
     bool _cmdGetNodeData( ICommand& command );
     bool _cmdGetNodeDataReply( ICommand& command );
@@ -65,6 +65,9 @@ public:
     /** The connection to this node. */
     ConnectionPtr outgoing;
 
+    /** The connection for control commands to this node, can be 0. */
+    lunchbox::Lockable< ConnectionPtr > control;
+
     /** The multicast connection to this node, can be 0. */
     lunchbox::Lockable< ConnectionPtr > outMulticast;
 
@@ -102,6 +105,7 @@ public:
     ~Node()
     {
         LBASSERT( !outgoing );
+        LBASSERT( !control.data );
         connectionDescriptions->clear();
     }
 };
@@ -323,6 +327,14 @@ ConnectionPtr Node::getConnection( const bool preferMulticast )
     return multicast ? multicast : _impl->outgoing;
 }
 
+ConnectionPtr Node::getControlConnection()
+{
+    ConnectionPtr control = _getControl();
+    if( control && !control->isClosed( ))
+        return control;
+    return _impl->outgoing;
+}
+
 ConnectionPtr Node::_getConnection( const bool preferMulticast )
 {
     ConnectionPtr multicast = preferMulticast ? getMulticast() : 0;
@@ -337,6 +349,12 @@ ConnectionPtr Node::_getMulticast() const
     return _impl->outMulticast.data;
 }
 
+ConnectionPtr Node::_getControl() const
+{
+    lunchbox::ScopedMutex<> mutex( _impl->control );
+    return _impl->control.data;
+}
+
 OCommand Node::send( const uint32_t cmd, const bool multicast )
 {
     ConnectionPtr connection = _getConnection( multicast );
@@ -507,10 +525,17 @@ void Node::_connect( ConnectionPtr connection )
     _impl->state = STATE_CONNECTED;
 }
 
+void Node::_setControl( ConnectionPtr connection )
+{
+    lunchbox::ScopedMutex<> mutex( _impl->control );
+    _impl->control.data = connection;
+}
+
 void Node::_disconnect()
 {
     _impl->state = STATE_CLOSED;
     _impl->outgoing = 0;
+    _setControl( 0 );
     _impl->outMulticast.data = 0;
     _impl->multicasts.clear();
 }
@@ -125,6 +125,22 @@ namespace detail { class Node; }
          * @version 1.0
          */
         CO_API ConnectionPtr getConnection( const bool multicast = false );
+
+        /**
+         * Get the connection for small, latency-sensitive commands.
+         *
+         * If Global::IATTR_NODE_CONTROL_CONNECTION is set, a second
+         * point-to-point connection is established to each connected node.
+         * Pings, barrier enters and max-version acknowledgements use it, so
+         * they are not queued behind bulk object data on the primary
+         * connection. Commands on different connections are not ordered with
+         * respect to each other.
+         *
+         * @return the control connection, or getConnection() if none is
+         *         established.
+         * @version 1.1.1
+         */
+        CO_API ConnectionPtr getControlConnection();
         //@}
 
         /** @name Messaging API */
@@ -182,6 +198,9 @@ namespace detail { class Node; }
         /** @internal @return the active multicast connection to this node. */
         ConnectionPtr _getMulticast() const;
 
+        /** @internal @return the control connection to this node, or 0. */
+        ConnectionPtr _getControl() const;
+
         /**
          * Activate and return a multicast connection.
          *
@@ -211,6 +230,7 @@ namespace detail { class Node; }
         void _setClosing();
         void _setClosed();
         void _connect( ConnectionPtr connection );
+        void _setControl( ConnectionPtr connection );
         void _disconnect();
         void _setLastReceive( const int64_t time );
         friend class LocalNode;
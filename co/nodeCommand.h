@@ -71,7 +71,11 @@ namespace co
         CMD_NODE_PING_REPLY,
         CMD_NODE_ADD_CONNECTION,
         CMD_NODE_SYNC_OBJECT,
-        CMD_NODE_SYNC_OBJECT_REPLY
+        CMD_NODE_SYNC_OBJECT_REPLY,
+        CMD_NODE_COMPLETE_REQUEST,
+        CMD_NODE_CONTROL_CONNECTION,
+        CMD_NODE_CONTROL_CONNECTION_BE,
+        CMD_NODE_CONNECT_CONTROL
         // check that not more than CMD_NODE_CUSTOM have been defined!
     };
 }
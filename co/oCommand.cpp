@@ -84,7 +84,8 @@ OCommand::~OCommand()
                  i != connections.end(); ++i )
             {
                 ConnectionPtr connection = *i;
-                connection->send( padding, delta, true );
+                if( !connection->isCompactSend( ))
+                    connection->send( padding, delta, true );
             }
         }
         for( ConnectionsCIter i = connections.begin();
@@ -164,14 +165,16 @@ void OCommand::sendData( const void* buffer LB_UNUSED, const uint64_t size,
     // Update size field
     uint8_t* bytes = getBuffer().getData();
     reinterpret_cast< uint64_t* >( bytes )[ 0 ] = _impl->size + size;
-    const uint64_t sendSize = _impl->isLocked ? size : LB_MAX( size,
-                                                               COMMAND_MINSIZE);
+    const uint64_t paddedSize = _impl->isLocked ? size :
+                                                  LB_MAX( size, COMMAND_MINSIZE );
     const Connections& connections = getConnections();
     for( ConnectionsCIter i = connections.begin(); i != connections.end(); ++i )
     {
         ConnectionPtr connection = *i;
         if ( connection )
-            connection->send( bytes, sendSize, _impl->isLocked );
+            connection->send( bytes, connection->isCompactSend() ? size :
+                                                                  paddedSize,
+                              _impl->isLocked );
         else
             LBERROR << "Can't send data, node is closed" << std::endl;
     }
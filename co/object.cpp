@@ -23,6 +23,7 @@
 #include "dataIStream.h"
 #include "dataOStream.h"
 #include "deltaMasterCM.h"
+#include "diffMasterCM.h"
 #include "fullMasterCM.h"
 #include "global.h"
 #include "log.h"
@@ -201,6 +202,14 @@ ObjectOCommand Object::send( NodePtr node, const uint32_t cmd,
                            instanceID );
 }
 
+ObjectOCommand Object::sendControl( NodePtr node, const uint32_t cmd,
+                                    const uint32_t instanceID )
+{
+    Connections connections( 1, node->getControlConnection( ));
+    return ObjectOCommand( connections, cmd, COMMANDTYPE_OBJECT, impl_->id,
+                           instanceID );
+}
+
 void Object::push( const uint128_t& groupID, const uint128_t& typeID,
                    const Nodes& nodes )
 {
@@ -212,6 +221,23 @@ uint128_t Object::commit( const uint32_t incarnation )
     return impl_->cm->commit( incarnation );
 }
 
+uint128_t Object::tryCommit( const uint32_t incarnation )
+{
+    if( isCommitBlocked( ))
+        return VERSION_INVALID;
+    return commit( incarnation );
+}
+
+bool Object::isCommitBlocked() const
+{
+    return impl_->cm->isCommitBlocked();
+}
+
+Object::SlaveLags Object::getSlaveLags() const
+{
+    return impl_->cm->getSlaveLags();
+}
+
 
 void Object::setupChangeManager( const Object::ChangeType type,
                                  const bool master, LocalNodePtr localNode,
@@ -252,6 +278,15 @@ void Object::setupChangeManager( const Object::ChangeType type,
                                                          masterInstanceID ));
             break;
 
+        case Object::DIFF:
+            LBASSERT( impl_->localNode );
+            if( master )
+                _setChangeManager( new DiffMasterCM( this ));
+            else
+                _setChangeManager( new VersionedSlaveCM( this,
+                                                         masterInstanceID ));
+            break;
+
         case Object::UNBUFFERED:
             LBASSERT( impl_->localNode );
             if( master )
@@ -326,6 +361,15 @@ uint128_t Object::sync( const uint128_t& version )
     return impl_->cm->sync( version );
 }
 
+void Object::unpackSlaveCommits( const DataIStreams& commits )
+{
+    for( DataIStreams::const_iterator i = commits.begin();
+         i != commits.end(); ++i )
+    {
+        unpack( **i );
+    }
+}
+
 uint128_t Object::getHeadVersion() const
 {
     return impl_->cm->getHeadVersion();
@@ -373,7 +417,8 @@ std::ostream& operator << ( std::ostream& os,const Object::ChangeType& type )
                    type == Object::STATIC ? "static" :
                    type == Object::INSTANCE ? "instance" :
                    type == Object::DELTA ? "delta" :
-                   type == Object::UNBUFFERED ? "unbuffered" : "ERROR" );
+                   type == Object::UNBUFFERED ? "unbuffered" :
+                   type == Object::DIFF ? "diff" : "ERROR" );
 }
 
 }
@@ -52,9 +52,19 @@ public:
         STATIC,            //!< non-versioned, unbuffered, static object.
         INSTANCE,          //!< use only instance data
         DELTA,             //!< use pack/unpack delta
-        UNBUFFERED         //!< versioned, but don't retain versions
+        UNBUFFERED,        //!< versioned, but don't retain versions
+        DIFF               //!< use binary deltas of instance data @version 1.1.1
     };
 
+    /** The version lag of one slave instance. @version 1.1.1 */
+    struct SlaveLag
+    {
+        NodePtr node;        //!< The node of the slave instance
+        uint32_t instanceID; //!< The instance identifier of the slave
+        uint64_t versions;   //!< Committed versions not yet applied
+    };
+    typedef std::vector< SlaveLag > SlaveLags; //!< @version 1.1.1
+
     /** Destruct the distributed object. @version 1.0 */
     CO_API virtual ~Object();
 
@@ -123,6 +133,27 @@ public:
     virtual uint64_t getMaxVersions() const
         { return std::numeric_limits< uint64_t >::max(); }
 
+    /**
+     * Coalesce versions for lagging slave instances.
+     *
+     * If this method returns true on the master instance, commit() does not
+     * block when a slave instance has reached its maximum number of queued
+     * versions. Instead, the node of this slave instance is excluded from
+     * the following commits. Once it has applied all versions sent to it, it
+     * receives the instance data of the next committed version in one
+     * transmission, skipping all intermediate versions. All other slave
+     * instances continue to receive each version. Commits of coalescing
+     * objects are send using unicast connections to preserve the order of
+     * commit and catch-up data.
+     *
+     * Changing the return value after the object has been registered is
+     * unsupported and causes undefined behavior.
+     *
+     * @return true to coalesce versions, false to block in commit().
+     * @version 1.1.1
+     */
+    virtual bool coalesceSlaveVersions() const { return false; }
+
     /**
      * Return the compressor to be used for data transmission.
      *
@@ -134,6 +165,23 @@ public:
      */
     CO_API virtual uint32_t chooseCompressor() const;
 
+    /**
+     * Return if the data of this object is written using a compact encoding.
+     *
+     * In compact mode, integers, sizes, container lengths and versions are
+     * written as variable-length integers, and sets of unsigned integers as
+     * differences between their sorted values. This reduces the size of
+     * metadata-heavy objects at the cost of encoding time. The mode is flagged
+     * in the transmitted data and transparent to the serialization methods.
+     *
+     * Changing the return value after the object has been registered is
+     * unsupported and causes undefined behavior.
+     *
+     * @return true to use the compact encoding, false otherwise.
+     * @version 1.1.1
+     */
+    virtual bool useCompactEncoding() const { return false; }
+
     /**
      * Return if this object needs a commit.
      *
@@ -205,6 +253,42 @@ public:
     CO_API virtual uint128_t commit( const uint32_t incarnation =
                                      CO_COMMIT_NEXT );
 
+    /**
+     * Commit a new version if it does not block.
+     *
+     * commit() blocks while a slave instance has reached the maximum number
+     * of queued versions, see getMaxVersions(). In this case, tryCommit()
+     * does not commit and returns immediately. The object keeps its changes,
+     * and the application decides how to proceed, e.g., to retry in the next
+     * frame or to call the blocking commit(). Only the version window of this
+     * object is considered, not the one of any child objects committed by an
+     * overridden commit().
+     *
+     * @param incarnation the commit incarnation for auto obsoletion.
+     * @return the result of commit(), or VERSION_INVALID if the version
+     *         window is full.
+     * @version 1.1.1
+     */
+    CO_API uint128_t tryCommit( const uint32_t incarnation = CO_COMMIT_NEXT );
+
+    /**
+     * @return true if commit() would block for a slave instance to catch up.
+     * @version 1.1.1
+     */
+    CO_API bool isCommitBlocked() const;
+
+    /**
+     * Get the version lag of all slave instances.
+     *
+     * Only slave instances limiting their queued versions report the applied
+     * versions to the master, and are therefore listed. Only valid on master
+     * instances.
+     *
+     * @return the version lag of all limiting slave instances.
+     * @version 1.1.1
+     */
+    CO_API SlaveLags getSlaveLags() const;
+
     /**
      * Automatically obsolete old versions.
      *
@@ -319,6 +403,19 @@ public:
      * @version 1.0
      */
     virtual void unpack( DataIStream& is ) { applyInstanceData( is ); }
+
+    /**
+     * Deserialize a batch of slave commits on the master instance.
+     *
+     * Called by sync( VERSION_HEAD ) with all queued slave commits in the
+     * order of their arrival. The default implementation calls unpack() for
+     * each stream in order. Overrides may skip or reorder slave commits, and
+     * do not need to read skipped streams.
+     *
+     * @param commits the input data streams of the slave commits.
+     * @version 1.1.1
+     */
+    CO_API virtual void unpackSlaveCommits( const DataIStreams& commits );
     //@}
 
     /** @name Messaging API */
@@ -339,6 +436,22 @@ public:
      */
     CO_API ObjectOCommand send( NodePtr node, const uint32_t cmd,
                                 const uint32_t instanceID = CO_INSTANCE_ALL );
+
+    /**
+     * @internal
+     * Send a small, latency-sensitive command to object instance(s) on
+     * another node.
+     *
+     * Like send(), but uses the control connection of the node, if one is
+     * established. The command is not ordered with respect to commands send
+     * using send(). Not to be used for bulk data.
+     *
+     * @sa Node::getControlConnection()
+     * @version 1.1.1
+     */
+    CO_API ObjectOCommand sendControl( NodePtr node, const uint32_t cmd,
+                                       const uint32_t instanceID =
+                                           CO_INSTANCE_ALL );
     //@}
 
     /** @name Notifications */
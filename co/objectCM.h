@@ -23,6 +23,7 @@
 
 #include <co/dispatcher.h>   // base class
 #include <co/masterCMCommand.h>
+#include <co/object.h>       // Object::SlaveLags
 #include <co/objectVersion.h> // VERSION_FOO values
 #include <co/types.h>
 
@@ -83,6 +84,16 @@ public:
     virtual uint128_t commit( const uint32_t incarnation LB_UNUSED )
         { LBUNIMPLEMENTED; return VERSION_NONE; }
 
+    /** @return true if commit() would block for slow slaves. */
+    virtual bool isCommitBlocked() const { return false; }
+
+    /** @return true if commit data may be send using multicast. */
+    virtual bool useMulticast() const { return true; }
+
+    /** @return the version lag of all slaves limiting queued versions. */
+    virtual Object::SlaveLags getSlaveLags() const
+        { return Object::SlaveLags(); }
+
     /**
      * Automatically obsolete old versions.
      *
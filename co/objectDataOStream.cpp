@@ -35,6 +35,8 @@ ObjectDataOStream::ObjectDataOStream( const ObjectCM* cm )
     const Object* object = cm->getObject();
     const uint32_t name = object->chooseCompressor();
     _initCompressor( name );
+    setCompact( object->useCompactEncoding( ));
+    setFlushOnDisable( true ); // end of a commit or of the mapping data
     LBLOG( LOG_OBJECTS )
         << "Using byte compressor 0x" << std::hex << name << std::dec << " for "
         << lunchbox::className( object ) << std::endl;
@@ -51,7 +53,20 @@ void ObjectDataOStream::enableCommit( const uint128_t& version,
                                       const Nodes& receivers )
 {
     _version = version;
-    _setupConnections( receivers );
+    if( _cm->useMulticast( ))
+        _setupConnections( receivers );
+    else
+    {
+        Connections connections;
+        for( Nodes::const_iterator i = receivers.begin();
+             i != receivers.end(); ++i )
+        {
+            ConnectionPtr connection = (*i)->getConnection();
+            if( connection )
+                connections.push_back( connection );
+        }
+        _setupConnections( connections );
+    }
     _enable();
 }
 
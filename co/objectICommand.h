@@ -30,7 +30,9 @@ enum ObjectCommands
     CMD_OBJECT_INSTANCE,
     CMD_OBJECT_DELTA,
     CMD_OBJECT_SLAVE_DELTA,
-    CMD_OBJECT_MAX_VERSION
+    CMD_OBJECT_MAX_VERSION,
+    CMD_OBJECT_FULL_VERSION,
+    CMD_OBJECT_CATCH_UP
     // check that not more then CMD_OBJECT_CUSTOM have been defined!
 };
 
@@ -117,25 +117,27 @@ void ObjectInstanceDataOStream::sendInstanceData( const Nodes& receivers )
 }
 
 void ObjectInstanceDataOStream::sendMapData( NodePtr node,
-                                             const uint32_t instanceID )
+                                             const uint32_t instanceID,
+                                             const bool useMulticast )
 {
     _command = CMD_NODE_OBJECT_INSTANCE_MAP;
     _nodeID = node->getNodeID();
     _instanceID = instanceID;
-    _setupConnection( node, true /* useMulticast */ );
+    _setupConnection( node, useMulticast );
     _resend();
     _clearConnections();
 }
 
 void ObjectInstanceDataOStream::enableMap( const uint128_t& version,
                                            NodePtr node,
-                                           const uint32_t instanceID )
+                                           const uint32_t instanceID,
+                                           const bool useMulticast )
 {
     _command = CMD_NODE_OBJECT_INSTANCE_MAP;
     _nodeID = node->getNodeID();
     _instanceID = instanceID;
     _version = version;
-    _setupConnection( node, true /* useMulticast */ );
+    _setupConnection( node, useMulticast );
     _enable();
 }
 
@@ -52,15 +52,26 @@ namespace co
         /** Synchronize a stored instance data. */
         void sync( const MasterCMCommand& command );
 
-        /** Set up mapping of the given version to the given node. */
+        /**
+         * Set up mapping of the given version to the given node, using
+         * multicast if available and requested.
+         */
         void enableMap( const uint128_t& version, NodePtr node,
-                        const uint32_t instanceID );
+                        const uint32_t instanceID,
+                        const bool useMulticast = true );
 
         /** Send-on-register instance data to all receivers. */
         void sendInstanceData( const Nodes& receivers );
 
-        /** Send mapping data to the node, using multicast if available. */
-        void sendMapData( NodePtr node, const uint32_t instanceID );
+        /**
+         * Send mapping data to the node, using multicast if available and
+         * requested.
+         */
+        void sendMapData( NodePtr node, const uint32_t instanceID,
+                          const bool useMulticast = true );
+
+        /** @return the saved, uncompressed instance data. */
+        const lunchbox::Bufferb& getSaveBuffer() { return getBuffer(); }
 
     protected:
         void sendData( const void* buffer, const uint64_t size,
@@ -27,6 +27,8 @@
 #include <lunchbox/scopedMutex.h>
 #include <lunchbox/spinLock.h>
 
+#include <algorithm>
+
 namespace co
 {
 namespace
@@ -49,6 +51,81 @@ typedef Map::const_iterator MapCIter;
 typedef std::vector< uint128_t > IDVector;
 typedef IDVector::iterator IDVectorIter;
 typedef IDVector::const_iterator IDVectorCIter;
+typedef std::vector< std::pair< uint128_t, const Entry* > > EntryVector;
+typedef EntryVector::const_iterator EntryVectorCIter;
+
+bool _lessID( const EntryVector::value_type& a, const EntryVector::value_type& b )
+{
+    return a.first < b.first;
+}
+
+/**
+ * Write the difference to the previous of a sorted list of identifiers,
+ * without its leading zero bytes.
+ */
+void _writeID( DataOStream& os, const uint128_t& id, uint128_t& last )
+{
+    LBASSERT( !( id < last ));
+    const uint64_t low = id.low() - last.low();
+    const uint64_t high = id.high() - last.high() - ( id.low() < last.low( ));
+    last = id;
+
+    uint8_t bytes[ 16 ];
+    uint8_t nBytes = 0;
+    for( size_t i = 0; i < 8; ++i )
+    {
+        bytes[ i ] = uint8_t( low >> ( i * 8 ));
+        bytes[ i + 8 ] = uint8_t( high >> ( i * 8 ));
+    }
+    for( uint8_t i = 0; i < 16; ++i )
+        if( bytes[ i ] )
+            nBytes = uint8_t( i + 1 );
+
+    os << nBytes << Array< const uint8_t >( bytes, nBytes );
+}
+
+/**
+ * Read an identifier written by _writeID() into last.
+ * @return false if the data is corrupt.
+ */
+bool _readID( DataIStream& is, uint128_t& last )
+{
+    const uint8_t nBytes = is.read< uint8_t >();
+    if( nBytes > 16 )
+    {
+        LBERROR << "Out-of-sync object map data, got identifier of "
+                << int( nBytes ) << " bytes" << std::endl;
+        return false;
+    }
+
+    uint8_t bytes[ 16 ] = { 0 };
+    is >> Array< uint8_t >( bytes, nBytes );
+
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for( size_t i = 0; i < 8; ++i )
+    {
+        low |= uint64_t( bytes[ i ] ) << ( i * 8 );
+        high |= uint64_t( bytes[ i + 8 ] ) << ( i * 8 );
+    }
+    low += last.low();
+    high += last.high() + ( low < last.low( ));
+    last = uint128_t( high, low );
+    return true;
+}
+
+/** @return the version increment between from and to, per 64 bit half. */
+uint128_t _getIncrement( const uint128_t& from, const uint128_t& to )
+{
+    return uint128_t( to.high() - from.high(), to.low() - from.low( ));
+}
+
+/** @return the version increased by the given increment. */
+uint128_t _increment( const uint128_t& version, const uint128_t& increment )
+{
+    return uint128_t( version.high() + increment.high(),
+                      version.low() + increment.low( ));
+}
 }
 
 namespace detail
@@ -106,7 +183,7 @@ public:
     /** Removed master objects since the last commit. */
     IDVector removed;
 
-    /** Changed master objects since the last commit. */
+    /** Changed master objects since the last commit, with the increment. */
     ObjectVersions changed;
 };
 }
@@ -145,6 +222,8 @@ bool ObjectMap::isDirty() const
 void ObjectMap::_commitMasters( const uint32_t incarnation )
 {
     lunchbox::ScopedFastWrite mutex( _impl->lock );
+    std::sort( _impl->added.begin(), _impl->added.end( ));
+    const IDVector& added = _impl->added;
 
     for( ObjectsCIter i =_impl->masters.begin(); i !=_impl->masters.end(); ++i )
     {
@@ -152,13 +231,19 @@ void ObjectMap::_commitMasters( const uint32_t incarnation )
         if( !object->isDirty() || object->getChangeType() == Object::STATIC )
             continue;
 
-        const ObjectVersion ov( object->getID(), object->commit( incarnation ));
-        Entry& entry = _impl->map[ ov.identifier ];
-        if( entry.version == ov.version )
+        const uint128_t& id = object->getID();
+        const uint128_t version = object->commit( incarnation );
+        Entry& entry = _impl->map[ id ];
+        if( entry.version == version )
             continue;
 
-        entry.version = ov.version;
-        _impl->changed.push_back( ov );
+        // objects added since the last commit are sent with their new version
+        if( !std::binary_search( added.begin(), added.end(), id ))
+        {
+            _impl->changed.push_back(
+                ObjectVersion( id, _getIncrement( entry.version, version )));
+        }
+        entry.version = version;
     }
     if( !_impl->changed.empty( ))
         setDirty( DIRTY_CHANGED );
@@ -168,99 +253,150 @@ void ObjectMap::serialize( DataOStream& os, const uint64_t dirtyBits )
 {
     Serializable::serialize( os, dirtyBits );
     lunchbox::ScopedFastWrite mutex( _impl->lock );
+    uint128_t last;
     if( dirtyBits == DIRTY_ALL )
     {
+        EntryVector entries;
+        entries.reserve( _impl->map.size( ));
         for( MapCIter i = _impl->map.begin(); i != _impl->map.end(); ++i )
-            os << i->first << i->second.version << i->second.type;
-        os << ObjectVersion();
+            entries.push_back( std::make_pair( i->first, &i->second ));
+        std::sort( entries.begin(), entries.end(), _lessID );
+
+        os << uint64_t( entries.size( ));
+        for( EntryVectorCIter i = entries.begin(); i != entries.end(); ++i )
+        {
+            _writeID( os, i->first, last );
+            os << i->second->version << i->second->type;
+        }
         return;
     }
 
     if( dirtyBits & DIRTY_ADDED )
     {
-        os << _impl->added;
+        std::sort( _impl->added.begin(), _impl->added.end( ));
+        os << uint64_t( _impl->added.size( ));
         for( IDVectorCIter i = _impl->added.begin();
              i != _impl->added.end(); ++i )
         {
             const Entry& entry = _impl->map[ *i ];
+            _writeID( os, *i, last );
             os << entry.version << entry.type;
         }
     }
     if( dirtyBits & DIRTY_REMOVED )
-        os << _impl->removed;
+    {
+        std::sort( _impl->removed.begin(), _impl->removed.end( ));
+        os << uint64_t( _impl->removed.size( ));
+        last = uint128_t();
+        for( IDVectorCIter i = _impl->removed.begin();
+             i != _impl->removed.end(); ++i )
+        {
+            _writeID( os, *i, last );
+        }
+    }
     if( dirtyBits & DIRTY_CHANGED )
-        os << _impl->changed;
+    {
+        std::sort( _impl->changed.begin(), _impl->changed.end( ));
+        os << uint64_t( _impl->changed.size( ));
+        last = uint128_t();
+        for( ObjectVersionsCIter i = _impl->changed.begin();
+             i != _impl->changed.end(); ++i )
+        {
+            _writeID( os, i->identifier, last );
+            os << i->version;
+        }
+    }
 }
 
 void ObjectMap::deserialize( DataIStream& is, const uint64_t dirtyBits )
 {
     Serializable::deserialize( is, dirtyBits );
     lunchbox::ScopedFastWrite mutex( _impl->lock );
+    uint128_t last;
     if( dirtyBits == DIRTY_ALL )
     {
         LBASSERT( _impl->map.empty( ));
 
-        ObjectVersion ov;
-        is >> ov;
-        while( ov != ObjectVersion( ))
+        // bulk insert into a pre-sized map
+        const uint64_t nEntries = is.read< uint64_t >();
+        _impl->map.rehash( size_t( nEntries ));
+        for( uint64_t i = 0; i < nEntries; ++i )
         {
-            LBASSERT( _impl->map.find( ov.identifier ) == _impl->map.end( ));
-            Entry& entry = _impl->map[ ov.identifier ];
-            entry.version = ov.version;
-            is >> entry.type >> ov;
+            if( !_readID( is, last ))
+                return;
+            const uint128_t id = last;
+            const uint128_t version = is.read< uint128_t >();
+            const uint32_t type = is.read< uint32_t >();
+            LBCHECK( _impl->map.insert( std::make_pair( id,
+                                          Entry( version, 0, type ))).second );
         }
         return;
     }
 
     if( dirtyBits & DIRTY_ADDED )
     {
-        IDVector added;
-        is >> added;
-
-        for( IDVectorCIter i = added.begin(); i != added.end(); ++i )
+        const uint64_t nAdded = is.read< uint64_t >();
+        for( uint64_t i = 0; i < nAdded; ++i )
         {
-            LBASSERT( _impl->map.find( *i ) == _impl->map.end( ));
-            Entry& entry = _impl->map[ *i ];
+            if( !_readID( is, last ))
+                return;
+            const uint128_t id = last;
+            LBASSERT( _impl->map.find( id ) == _impl->map.end( ));
+            Entry& entry = _impl->map[ id ];
             is >> entry.version >> entry.type;
         }
     }
     if( dirtyBits & DIRTY_REMOVED )
     {
-        IDVector removed;
-        is >> removed;
-
-        for( IDVectorCIter i = removed.begin(); i != removed.end(); ++i )
+        const uint64_t nRemoved = is.read< uint64_t >();
+        last = uint128_t();
+        for( uint64_t i = 0; i < nRemoved; ++i )
         {
-            MapIter it = _impl->map.find( *i );
+            if( !_readID( is, last ))
+                return;
+            MapIter it = _impl->map.find( last );
             LBASSERT( it != _impl->map.end( ));
+            if( it == _impl->map.end( ))
+                continue;
+
             _impl->_removeObject( it->second );
             _impl->map.erase( it );
         }
     }
     if( dirtyBits & DIRTY_CHANGED )
     {
-        ObjectVersions changed;
-        is >> changed;
-
-        for( ObjectVersionsCIter i = changed.begin(); i!=changed.end(); ++i)
+        const uint64_t nChanged = is.read< uint64_t >();
+        last = uint128_t();
+        for( uint64_t i = 0; i < nChanged; ++i )
         {
-            const ObjectVersion& ov = *i;
-            LBASSERT( _impl->map.find( ov.identifier ) != _impl->map.end( ));
+            if( !_readID( is, last ))
+                return;
+            const uint128_t id = last;
+            const uint128_t increment = is.read< uint128_t >();
+            MapIter it = _impl->map.find( id );
+            LBASSERT( it != _impl->map.end( ));
+            if( it == _impl->map.end( ))
+                continue;
+
+            // also track unmapped entries for later map() calls
+            Entry& entry = it->second;
+            entry.version = _increment( entry.version, increment );
+            if( !entry.instance )
+                continue;
 
-            Entry& entry = _impl->map[ ov.identifier ];
-            if( !entry.instance || entry.instance->isMaster( ))
+            if( entry.instance->isMaster( ))
             {
-                LBERROR << "Empty or master instance for object "
-                        << ov.identifier << " in slave object map" << std::endl;
+                LBERROR << "Master instance for object " << id
+                        << " in slave object map" << std::endl;
                 continue;
             }
 
-            if( ov.version < entry.instance->getVersion( ))
+            if( entry.version < entry.instance->getVersion( ))
                 LBWARN << "Cannot sync " << entry.instance
-                       << " to older version " << ov.version << ", got "
+                       << " to older version " << entry.version << ", got "
                        << entry.instance->getVersion() << std::endl;
             else
-                entry.version = entry.instance->sync( ov.version );
+                entry.instance->sync( entry.version );
         }
     }
 }
@@ -133,6 +133,10 @@ protected:
                                      const uint64_t dirtyBits ) override;
     /** @internal */
     ChangeType getChangeType() const override { return DELTA; }
+
+    /** @internal Versions and sizes are sent as varints. */
+    bool useCompactEncoding() const override { return true; }
+
     CO_API void notifyAttached() override; //!< @internal
 
     /** @internal The changed parts of the object since the last serialize(). */
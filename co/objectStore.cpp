@@ -103,6 +103,8 @@ ObjectStore::ObjectStore( LocalNode* localNode, a_ssize_t* counters )
         CmdFunc( this, &ObjectStore::_cmdSync ), queue );
     localNode->_registerCommand( CMD_NODE_SYNC_OBJECT_REPLY,
         CmdFunc( this, &ObjectStore::_cmdSyncReply ), 0 );
+    localNode->_registerCommand( CMD_NODE_COMPLETE_REQUEST,
+        CmdFunc( this, &ObjectStore::_cmdCompleteRequest ), queue );
 }
 
 ObjectStore::~ObjectStore()
@@ -145,6 +147,7 @@ void ObjectStore::clear( )
     LBASSERT( !_instanceCache || _instanceCache->isEmpty( ));
 
     _objects->clear();
+    _instances.clear();
     _sendQueue.clear();
 }
 
@@ -271,9 +274,10 @@ void ObjectStore::_attach( Object* object, const UUID& id,
                       "first is " << ( objects[0]->isMaster() ? "master " :
                                        "slave " ) << *objects[0] );
         objects.push_back( object );
+        _instances[ InstanceKey( id, instanceID )] = object;
     }
 
-    _localNode->flushCommands(); // redispatch pending commands
+    _localNode->_objectAttached( id ); // redispatch pending commands
 
     LBLOG( LOG_OBJECTS ) << "attached " << *object << " @"
                          << static_cast< void* >( object ) << std::endl;
@@ -317,6 +321,7 @@ void ObjectStore::swap( Object* oldObject, Object* newObject )
 
     newObject->transfer( oldObject );
     *j = newObject;
+    _instances[ InstanceKey( id, newObject->getInstanceID( ))] = newObject;
 }
 
 void ObjectStore::_detach( Object* object )
@@ -342,6 +347,7 @@ void ObjectStore::_detach( Object* object )
         objects.erase( i );
         if( objects.empty( ))
             _objects->erase( id );
+        _instances.erase( InstanceKey( id, object->getInstanceID( )));
     }
 
     LBASSERT( object->getInstanceID() != CO_INSTANCE_INVALID );
@@ -350,7 +356,8 @@ void ObjectStore::_detach( Object* object )
 }
 
 uint32_t ObjectStore::mapNB( Object* object, const UUID& id,
-                             const uint128_t& version, NodePtr master )
+                             const uint128_t& version, NodePtr master,
+                             const CompletionHandler& handler )
 {
     LB_TS_NOT_THREAD( _receiverThread );
     LBLOG( LOG_OBJECTS )
@@ -394,6 +401,10 @@ uint32_t ObjectStore::mapNB( Object* object, const UUID& id,
     const bool useCache = _checkInstanceCache( id, minCachedVersion,
                                                maxCachedVersion,
                                                masterInstanceID );
+    if( handler )
+        _addCompletion( request.getID(),
+                        boost::bind( &ObjectStore::mapSync, this,
+                                     request.getID( )), handler, master, true );
     object->notifyAttach();
     master->send( CMD_NODE_MAP_OBJECT )
         << version << minCachedVersion << maxCachedVersion << id
@@ -450,14 +461,28 @@ bool ObjectStore::mapSync( const uint32_t requestID )
 f_bool_t ObjectStore::sync( Object* object, NodePtr master, const UUID& id,
                             const uint32_t instanceID )
 {
-    const uint32_t request = _startSync( object, master, id, instanceID );
+    const uint32_t request = _startSync( object, master, id, instanceID,
+                                         CompletionHandler( ));
     const FuturebImpl::Func& func = boost::bind( &ObjectStore::_finishSync,
                                                  this, request, object );
     return f_bool_t( new FuturebImpl( func ));
 }
 
+void ObjectStore::sync( Object* object, NodePtr master, const UUID& id,
+                        const uint32_t instanceID,
+                        const CompletionHandler& handler )
+{
+    LBASSERT( handler );
+    if( _startSync( object, master, id, instanceID, handler ) ==
+        LB_UNDEFINED_UINT32 )
+    {
+        handler( false );
+    }
+}
+
 uint32_t ObjectStore::_startSync( Object* object, NodePtr master,
-                                  const UUID& id, const uint32_t instanceID )
+                                  const UUID& id, const uint32_t instanceID,
+                                  const CompletionHandler& handler )
 {
     LB_TS_NOT_THREAD( _receiverThread );
     LBLOG( LOG_OBJECTS )
@@ -506,6 +531,12 @@ uint32_t ObjectStore::_startSync( Object* object, NodePtr master,
         }
     }
 
+    if( handler )
+        _addCompletion( request.getID(),
+                        boost::bind( &ObjectStore::_finishSync, this,
+                                     request.getID(), object ), handler,
+                        master, false );
+
     // Use stream expected by MasterCMCommand
     master->send( CMD_NODE_SYNC_OBJECT )
         << VERSION_NEWEST << minCachedVersion << maxCachedVersion << id
@@ -544,6 +575,61 @@ bool ObjectStore::_finishSync( const uint32_t requestID, Object* object )
     return true;
 }
 
+void ObjectStore::_addCompletion( const uint32_t requestID,
+                                  const boost::function< bool() >& finish,
+                                  const CompletionHandler& handler,
+                                  NodePtr master, const bool map )
+{
+    const Completion completion = { finish, handler, master->getNodeID(),
+                                    map, false };
+    lunchbox::ScopedFastWrite mutex( _completions );
+    _completions.data[ requestID ] = completion;
+}
+
+void ObjectStore::_scheduleCompletion( const uint32_t requestID )
+{
+    {
+        lunchbox::ScopedFastWrite mutex( _completions );
+        CompletionHash::iterator i = _completions->find( requestID );
+        if( i == _completions->end( ) || i->second.scheduled )
+            return;
+        i->second.scheduled = true;
+    }
+    // finish the operation on the command thread, the request is served
+    _localNode->send( CMD_NODE_COMPLETE_REQUEST ) << requestID;
+}
+
+void ObjectStore::_failCompletions( const NodeID& nodeID )
+{
+    std::vector< std::pair< uint32_t, bool > > failed;
+    {
+        lunchbox::ScopedFastWrite mutex( _completions );
+        for( CompletionHash::iterator i = _completions->begin();
+             i != _completions->end(); ++i )
+        {
+            Completion& completion = i->second;
+            if( completion.scheduled || completion.master != nodeID )
+                continue;
+            completion.scheduled = true;
+            failed.push_back( std::make_pair( i->first, completion.map ));
+        }
+    }
+
+    // The reply of the removed node will never arrive, serve the requests
+    // with a failure so the completion handlers are called with false.
+    for( size_t i = 0; i < failed.size(); ++i )
+    {
+        const uint32_t requestID = failed[i].first;
+        LBWARN << "Node " << nodeID << " removed, failing request "
+               << requestID << std::endl;
+        if( failed[i].second )
+            _localNode->serveRequest( requestID, VERSION_NONE );
+        else
+            _localNode->serveRequest( requestID, false );
+        _localNode->send( CMD_NODE_COMPLETE_REQUEST ) << requestID;
+    }
+}
+
 void ObjectStore::unmap( Object* object )
 {
     LBASSERT( object );
@@ -676,6 +762,22 @@ bool ObjectStore::dispatchObjectCommand( ICommand& cmd )
     const UUID& id = command.getObjectID();
     const uint32_t instanceID = command.getInstanceID();
 
+    if( instanceID <= CO_INSTANCE_MAX )
+    {
+        // Fast path: direct lookup of the addressed instance
+        InstancesHash::const_iterator i =
+            _instances.find( InstanceKey( id, instanceID ));
+        if( i != _instances.end( ))
+        {
+            LBCHECK( i->second->dispatchCommand( command ));
+            return true;
+        }
+
+        // unknown id: not yet attached, retry later
+        LBASSERTINFO( _objects->find( id ) == _objects->end(), command );
+        return false;
+    }
+
     ObjectsHash::const_iterator i = _objects->find( id );
 
     if( i == _objects->end( ))
@@ -686,30 +788,8 @@ bool ObjectStore::dispatchObjectCommand( ICommand& cmd )
     const Objects& objects = i->second;
     LBASSERTINFO( !objects.empty(), command );
 
-    if( instanceID <= CO_INSTANCE_MAX )
-    {
-        for( Objects::const_iterator j = objects.begin(); j!=objects.end(); ++j)
-        {
-            Object* object = *j;
-            if( instanceID == object->getInstanceID( ))
-            {
-                LBCHECK( object->dispatchCommand( command ));
-                return true;
-            }
-        }
-        LBUNREACHABLE;
-        return false;
-    }
-
-    Objects::const_iterator j = objects.begin();
-    Object* object = *j;
-    LBCHECK( object->dispatchCommand( command ));
-
-    for( ++j; j != objects.end(); ++j )
-    {
-        object = *j;
-        LBCHECK( object->dispatchCommand( command ));
-    }
+    for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
+        LBCHECK( (*j)->dispatchCommand( command ));
     return true;
 }
 
@@ -991,6 +1071,7 @@ bool ObjectStore::_cmdMapReply( ICommand& command )
     }
 
     _localNode->serveRequest( requestID, version );
+    _scheduleCompletion( requestID );
     return true;
 }
 
@@ -1047,6 +1128,8 @@ bool ObjectStore::_cmdUnmap( ICommand& command )
     {
         lunchbox::ScopedFastWrite mutex( _objects );
         _objects->erase( i );
+        for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
+            _instances.erase( InstanceKey( objectID, (*j)->getInstanceID( )));
     }
 
     for( Objects::const_iterator j = objects.begin(); j != objects.end(); ++j )
@@ -1163,6 +1246,7 @@ bool ObjectStore::_cmdSyncReply( ICommand& command )
     }
 
     _localNode->serveRequest( requestID, result );
+    _scheduleCompletion( requestID );
     return true;
 }
 
@@ -1273,13 +1357,16 @@ bool ObjectStore::_cmdRemoveNode( ICommand& command )
     Node* node = command.get< Node* >();
     const uint32_t requestID = command.get< uint32_t >();
 
-    lunchbox::ScopedFastWrite mutex( _objects );
-    for( ObjectsHashCIter i = _objects->begin(); i != _objects->end(); ++i )
     {
-        const Objects& objects = i->second;
-        for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
-            (*j)->removeSlaves( node );
+        lunchbox::ScopedFastWrite mutex( _objects );
+        for( ObjectsHashCIter i = _objects->begin(); i != _objects->end(); ++i )
+        {
+            const Objects& objects = i->second;
+            for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
+                (*j)->removeSlaves( node );
+        }
     }
+    _failCompletions( node->getNodeID( ));
 
     if( requestID != LB_UNDEFINED_UINT32 )
         _localNode->serveRequest( requestID );
@@ -1304,6 +1391,27 @@ bool ObjectStore::_cmdPush( ICommand& command )
     return true;
 }
 
+bool ObjectStore::_cmdCompleteRequest( ICommand& command )
+{
+    LB_TS_THREAD( _commandThread );
+
+    const uint32_t requestID = command.get< uint32_t >();
+    Completion completion;
+    {
+        lunchbox::ScopedFastWrite mutex( _completions );
+        CompletionHash::iterator i = _completions->find( requestID );
+        LBASSERT( i != _completions->end( ));
+        if( i == _completions->end( ))
+            return true;
+
+        completion = i->second;
+        _completions->erase( i );
+    }
+
+    completion.handler( completion.finish( ));
+    return true;
+}
+
 std::ostream& operator << ( std::ostream& os, ObjectStore* objectStore )
 {
     if( !objectStore )
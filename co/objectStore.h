@@ -28,6 +28,8 @@
 #include <lunchbox/lockable.h>  // member
 #include <lunchbox/spinLock.h>  // member
 #include <lunchbox/stdExt.h>    // member
+#include <boost/function/function0.hpp> // member
+#include <boost/function/function1.hpp> // member
 
 #include "dataIStreamQueue.h"  // member
 
@@ -94,9 +96,19 @@ public:
      */
     void deregister( Object* object );
 
-    /** Start mapping a distributed object. */
+    /** Function called with the result of an asynchronous operation. */
+    typedef boost::function< void( bool ) > CompletionHandler;
+
+    /**
+     * Start mapping a distributed object.
+     *
+     * If a handler is given, the mapping is finalized on the command thread
+     * and the handler is called with its result. The request identifier must
+     * not be passed to mapSync() in this case.
+     */
     uint32_t mapNB( Object* object, const UUID& id, const uint128_t& version,
-                    NodePtr master );
+                    NodePtr master,
+                    const CompletionHandler& handler = CompletionHandler( ));
 
     /** Finalize the mapping of a distributed object. */
     bool mapSync( const uint32_t requestID );
@@ -104,6 +116,10 @@ public:
     /** Synchronize an object. */
     f_bool_t sync( Object* object, NodePtr master, const UUID& id,
                    const uint32_t instanceID );
+
+    /** Synchronize an object, calling the handler from the command thread. */
+    void sync( Object* object, NodePtr master, const UUID& id,
+               const uint32_t instanceID, const CompletionHandler& handler );
     /**
      * Unmap a mapped object.
      *
@@ -195,6 +211,23 @@ private:
      */
     lunchbox::Lockable< ObjectsHash, lunchbox::SpinLock > _objects;
 
+    typedef std::pair< lunchbox::uint128_t, uint32_t > InstanceKey;
+    struct InstanceKeyHash
+    {
+        size_t operator()( const InstanceKey& key ) const
+        {
+            return size_t( key.first.high() ^ ( key.first.low() * 31u ) ^
+                           key.second );
+        }
+    };
+    typedef stde::hash_map< InstanceKey, Object*,
+                            InstanceKeyHash > InstancesHash;
+
+    /** All attached objects by (identifier, instance identifier).
+     *   - updated together with _objects, only used in receiver thread
+     */
+    InstancesHash _instances;
+
     struct SendQueueItem
     {
         int64_t age;
@@ -209,13 +242,40 @@ private:
     DataIStreamQueue _pushData;    //!< Object::push() queue
     a_ssize_t* const _counters; // LocalNode performance counters
 
+    /** An asynchronous map or sync operation with a completion handler. */
+    struct Completion
+    {
+        boost::function< bool() > finish; //!< finalizes the operation
+        CompletionHandler handler; //!< called with the result of finish
+        NodeID master; //!< the node serving the request
+        bool map; //!< map or sync operation
+        bool scheduled; //!< request served and completion scheduled
+    };
+    typedef stde::hash_map< uint32_t, Completion > CompletionHash;
+
+    /** Pending completions by request identifier. */
+    lunchbox::Lockable< CompletionHash, lunchbox::SpinLock > _completions;
+
     void _attach( Object* object, const UUID& id, const uint32_t instanceID );
     void _detach( Object* object );
 
 
     /** Start synchronizing an object. */
     uint32_t _startSync( Object* object, NodePtr master, const UUID& id,
-                         const uint32_t instanceID );
+                         const uint32_t instanceID,
+                         const CompletionHandler& handler );
+
+    /** Remember the completion of the given request. */
+    void _addCompletion( const uint32_t requestID,
+                         const boost::function< bool() >& finish,
+                         const CompletionHandler& handler,
+                         NodePtr master, const bool map );
+
+    /** Schedule the completion handler of a served request, if any. */
+    void _scheduleCompletion( const uint32_t requestID );
+
+    /** Fail all not yet served completions of the given node. */
+    void _failCompletions( const NodeID& nodeID );
 
     /** Finalize the synchronization of a distributed object. */
     bool _finishSync( const uint32_t requestID, Object* object );
@@ -241,6 +301,7 @@ private:
     bool _cmdDisableSendOnRegister( ICommand& command );
     bool _cmdRemoveNode( ICommand& command );
     bool _cmdPush( ICommand& command );
+    bool _cmdCompleteRequest( ICommand& command );
 
     LB_TS_VAR( _receiverThread );
     LB_TS_VAR( _commandThread );
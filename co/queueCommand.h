@@ -29,6 +29,8 @@ namespace co
         CMD_QUEUE_GET_ITEM = CMD_OBJECT_CUSTOM, // 10
         CMD_QUEUE_EMPTY,
         CMD_QUEUE_ITEM,
+        CMD_QUEUE_ITEMS,
+        CMD_QUEUE_STEAL,
         CMD_QUEUE_CUSTOM = 15 //!< Commands for subclasses of queues start here
     };
 }
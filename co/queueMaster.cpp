@@ -21,7 +21,10 @@
 
 #include "queueMaster.h"
 
+#include "connection.h"
 #include "dataOStream.h"
+#include "global.h"
+#include "localNode.h"
 #include "objectICommand.h"
 #include "objectOCommand.h"
 #include "queueCommand.h"
@@ -30,6 +33,8 @@
 #include <lunchbox/buffer.h>
 #include <lunchbox/mtQueue.h>
 
+#include <algorithm>
+
 namespace co
 {
 
@@ -39,10 +44,13 @@ namespace detail
 class ItemBuffer : public lunchbox::Bufferb, public lunchbox::Referenced
 {
 public:
+    /** Take over the data of the given buffer, leaving it empty. */
     ItemBuffer( lunchbox::Bufferb& from )
-        : lunchbox::Bufferb( from )
+        : lunchbox::Bufferb()
         , lunchbox::Referenced()
-    {}
+    {
+        swap( from );
+    }
 
     ~ItemBuffer()
     {}
@@ -66,36 +74,145 @@ public:
         const uint32_t itemsRequested = command.get< uint32_t >();
         const uint32_t slaveInstanceID = command.get< uint32_t >();
         const int32_t requestID = command.get< int32_t >();
+        const uint32_t load = command.get< uint32_t >();
+        const bool steal = command.get< bool >();
+
+        Connections connections( 1, command.getNode()->getConnection( ));
+        _sendItems( command, connections, itemsRequested, slaveInstanceID,
+                    requestID, load, steal );
+
+        // write coalesced replies, the slave might be waiting for them
+        if( connections.front( ))
+            connections.front()->flush();
+        return true;
+    }
+
+    typedef lunchbox::MTQueue< ItemBufferPtr > ItemQueue;
 
+    ItemQueue queue;
+
+private:
+    const co::QueueMaster& _parent;
+
+    /** The last known state of a slave, updated on each item request. */
+    struct Slave
+    {
+        NodeID nodeID;
+        uint32_t instanceID;
+        uint32_t load;
+
+        bool operator < ( const Slave& rhs ) const { return load > rhs.load; }
+    };
+    typedef std::vector< Slave > Slaves;
+    typedef Slaves::iterator SlavesIter;
+    typedef Slaves::const_iterator SlavesCIter;
+
+    Slaves _slaves; //!< only used from the command thread
+
+    void _sendItems( co::ObjectICommand& command,
+                     const Connections& connections,
+                     const uint32_t itemsRequested,
+                     const uint32_t slaveInstanceID, const int32_t requestID,
+                     const uint32_t load, const bool steal )
+    {
         typedef std::vector< ItemBufferPtr > Items;
         Items items;
         queue.tryPop( itemsRequested, items );
+        _updateSlave( command.getNode()->getNodeID(), slaveInstanceID,
+                      load + uint32_t( items.size( )));
 
-        Connections connections( 1, command.getNode()->getConnection( ));
-        for( Items::const_iterator i = items.begin(); i != items.end(); ++i )
+        // Pack as many items as fit into one object buffer per command
+        const uint64_t maxSize = Global::getObjectBufferSize();
+        Items::const_iterator i = items.begin();
+        while( i != items.end( ))
         {
-            co::ObjectOCommand cmd( connections, CMD_QUEUE_ITEM,
+            Items::const_iterator end = i;
+            uint64_t size = 0;
+            uint32_t nItems = 0;
+            do
+            {
+                size += sizeof( uint64_t ) + (*end)->getSize();
+                ++nItems;
+                ++end;
+            }
+            while( end != items.end() &&
+                   size + sizeof( uint64_t ) + (*end)->getSize() <= maxSize );
+
+            co::ObjectOCommand cmd( connections, CMD_QUEUE_ITEMS,
                                     COMMANDTYPE_OBJECT, _parent.getID(),
                                     slaveInstanceID );
+            cmd << requestID << nItems;
+            for( ; i != end; ++i )
+            {
+                const ItemBufferPtr item = *i;
+                cmd << uint64_t( item->getSize( ));
+                if( !item->isEmpty( ))
+                    cmd << Array< const void >( item->getData(),
+                                                item->getSize( ));
+            }
+        }
 
-            const ItemBufferPtr item = *i;
-            if( !item->isEmpty( ))
-                cmd << Array< const void >( item->getData(), item->getSize( ));
+        if( itemsRequested <= items.size( ))
+            return;
+
+        co::ObjectOCommand empty( connections, CMD_QUEUE_EMPTY,
+                                  COMMANDTYPE_OBJECT, command.getObjectID(),
+                                  slaveInstanceID );
+        empty << requestID;
+        if( !steal )
+        {
+            empty << uint32_t( 0 );
+            return;
         }
 
-        if( itemsRequested > items.size( ))
-            co::ObjectOCommand( connections, CMD_QUEUE_EMPTY,
-                                COMMANDTYPE_OBJECT, command.getObjectID(),
-                                slaveInstanceID ) << requestID;
-        return true;
-    }
+        // Steal victims: all other connected slaves with queued items,
+        // busiest first
+        LocalNodePtr localNode = command.getLocalNode();
+        Slaves victims;
+        for( SlavesIter j = _slaves.begin(); j != _slaves.end(); )
+        {
+            NodePtr node = localNode->getNode( j->nodeID );
+            if( !node || !node->isReachable( ))
+            {
+                j = _slaves.erase( j ); // slave node has left
+                continue;
+            }
 
-    typedef lunchbox::MTQueue< ItemBufferPtr > ItemQueue;
+            if( j->instanceID != slaveInstanceID ||
+                j->nodeID != command.getNode()->getNodeID( ))
+            {
+                victims.push_back( *j );
+            }
+            ++j;
+        }
+        std::sort( victims.begin(), victims.end( ));
 
-    ItemQueue queue;
+        empty << uint32_t( victims.size( ));
+        for( SlavesCIter j = victims.begin(); j != victims.end(); ++j )
+            empty << j->nodeID << j->instanceID;
+    }
 
-private:
-    const co::QueueMaster& _parent;
+    void _updateSlave( const NodeID& nodeID, const uint32_t instanceID,
+                       const uint32_t load )
+    {
+        for( SlavesIter i = _slaves.begin(); i != _slaves.end(); ++i )
+        {
+            if( i->nodeID == nodeID && i->instanceID == instanceID )
+            {
+                if( load == 0 ) // nothing to steal until the next request
+                    _slaves.erase( i );
+                else
+                    i->load = load;
+                return;
+            }
+        }
+
+        if( load > 0 )
+        {
+            const Slave slave = { nodeID, instanceID, load };
+            _slaves.push_back( slave );
+        }
+    }
 };
 }
 
@@ -117,7 +234,7 @@ void QueueMaster::attach( const UUID& id, const uint32_t instanceID )
 {
     Object::attach( id, instanceID );
 
-    CommandQueue* queue = getLocalNode()->getCommandThreadQueue();
+    CommandQueue* queue = getLocalNode()->getCommandThreadQueue( id );
     registerCommand( CMD_QUEUE_GET_ITEM,
                      CommandFunc< detail::QueueMaster >(
                          _impl, &detail::QueueMaster::cmdGetItem ), queue );
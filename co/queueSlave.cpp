@@ -23,36 +23,235 @@
 
 #include "buffer.h"
 #include "commandQueue.h"
+#include "connection.h"
 #include "dataIStream.h"
 #include "global.h"
+#include "localNode.h"
+#include "oCommand.h"
 #include "objectOCommand.h"
 #include "objectICommand.h"
 #include "queueCommand.h"
 #include "exception.h"
 
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
+
+#include <algorithm>
+#include <deque>
+
 namespace co
 {
+namespace
+{
+lunchbox::a_int32_t _request; //!< identifies item and steal requests
+}
+
 namespace detail
 {
+/** @return the size of the command header preceding an item's data. */
+inline uint64_t getHeaderSize()
+{
+    return OCommand::getSize() + sizeof( UUID ) + sizeof( uint32_t );
+}
+
 class QueueSlave
 {
 public:
     QueueSlave( const uint32_t mark, const uint32_t amount)
         : masterInstanceID( CO_INSTANCE_ALL )
+        , adaptive( mark == LB_UNDEFINED_UINT32 &&
+                    amount == LB_UNDEFINED_UINT32 )
+        , minPrefetch( std::max( 1, Global::getIAttribute(
+                                     Global::IATTR_TILE_QUEUE_MIN_SIZE )))
+        , maxPrefetch( std::max( minPrefetch, uint32_t( Global::getIAttribute(
+                                     Global::IATTR_QUEUE_PREFETCH_MAX ))))
         , prefetchMark( mark == LB_UNDEFINED_UINT32 ?
                     Global::getIAttribute( Global::IATTR_TILE_QUEUE_MIN_SIZE ) :
                         mark )
         , prefetchAmount( amount == LB_UNDEFINED_UINT32 ?
                       Global::getIAttribute( Global::IATTR_TILE_QUEUE_REFILL ) :
                           amount )
+        , stealMode( co::QueueSlave::STEAL_NONE )
+        , timedRequest( 0 )
+        , requestTime( 0.f )
+        , returnTime( -1.f )
+        , rtt( 0.f )
+        , itemTime( 0.f )
     {}
 
+    /** Note the start of a pop(), measuring the consumer's item time. */
+    void popStarted()
+    {
+        if( !adaptive || returnTime < 0.f )
+            return;
+
+        _smooth( itemTime, clock.getTimef() - returnTime );
+        returnTime = -1.f;
+        _adapt();
+    }
+
+    /** Note an item returned by pop(). */
+    void popFinished()
+    {
+        if( adaptive )
+            returnTime = clock.getTimef();
+    }
+
+    /** Note a CMD_QUEUE_GET_ITEM sent for the given request. */
+    void requested( const int32_t request )
+    {
+        if( !adaptive || timedRequest != 0 )
+            return;
+
+        timedRequest = request;
+        requestTime = clock.getTimef();
+    }
+
+    /** Note a reply from the master for the given request. */
+    void replied( const int32_t request )
+    {
+        if( !adaptive || timedRequest != request )
+            return;
+
+        _smooth( rtt, clock.getTimef() - requestTime );
+        timedRequest = 0;
+        _adapt();
+    }
+
+    /** Split a CMD_QUEUE_ITEMS batch into CMD_QUEUE_ITEM commands. */
+    void unpack( ObjectICommand& command )
+    {
+        const uint64_t headerSize = getHeaderSize();
+        const uint8_t* header =
+            static_cast< const uint8_t* >( command.getBuffer()->getData( ));
+        const uint32_t nItems = command.get< uint32_t >();
+
+        ICommands unpacked;
+        unpacked.reserve( nItems );
+        for( uint32_t i = 0; i < nItems; ++i )
+        {
+            const uint64_t size = command.get< uint64_t >();
+            BufferPtr buffer = new Buffer;
+            buffer->reserve( headerSize + size );
+            buffer->append( header, headerSize );
+            if( size > 0 )
+                buffer->append( static_cast< const uint8_t* >(
+                                    command.getRemainingBuffer( size )), size );
+            reinterpret_cast< uint64_t* >( buffer->getData( ))[ 0 ] =
+                buffer->getSize();
+
+            ICommand item( command.getLocalNode(), command.getRemoteNode(),
+                           buffer, command.isSwapping( ));
+            item.setCommand( CMD_QUEUE_ITEM );
+            unpacked.push_back( item );
+        }
+
+        lunchbox::ScopedFastWrite mutex( lock );
+        items.insert( items.end(), unpacked.begin(), unpacked.end( ));
+    }
+
+    /** Pop the next unpacked item, @return false if none is queued. */
+    bool popItem( ICommand& item )
+    {
+        lunchbox::ScopedFastWrite mutex( lock );
+        if( items.empty( ))
+            return false;
+
+        item = items.front();
+        items.pop_front();
+        return true;
+    }
+
+    /** Remove up to half of the unpacked items for a stealing peer. */
+    ICommands steal( const uint32_t amount )
+    {
+        lunchbox::ScopedFastWrite mutex( lock );
+        const size_t nItems = std::min( size_t( amount ),
+                                        ( items.size() + 1 ) / 2 );
+        const ICommands stolen( items.end() - nItems, items.end( ));
+        items.erase( items.end() - nItems, items.end( ));
+        return stolen;
+    }
+
+    /** @return the number of locally queued items. */
+    size_t getLoad() const
+    {
+        lunchbox::ScopedFastWrite mutex( lock );
+        return items.size();
+    }
+
+    /** Order the victims reported by the master for the given mode. */
+    void setVictims( ObjectICommand& command )
+    {
+        victims.clear();
+        const uint32_t nPeers = command.get< uint32_t >();
+        for( uint32_t i = 0; i < nPeers; ++i )
+        {
+            Peer peer;
+            command >> peer.nodeID >> peer.instanceID;
+            victims.push_back( peer );
+        }
+
+        // master sends victims by decreasing load
+        if( stealMode != co::QueueSlave::STEAL_RANDOM )
+            return;
+
+        for( size_t i = victims.size(); i > 1; --i )
+            std::swap( victims[ i - 1 ], victims[ rng.get< uint32_t >() % i ]);
+    }
+
+    /** Peer slave of the same queue, as reported by the master. */
+    struct Peer
+    {
+        NodeID nodeID;
+        uint32_t instanceID;
+    };
+    std::deque< Peer > victims; //!< steal candidates of the current pop
+
     co::CommandQueue queue;
     NodePtr master;
     uint32_t masterInstanceID;
 
-    const uint32_t prefetchMark;
-    const uint32_t prefetchAmount;
+    /** Size prefetching to cover one round trip of consumer work. */
+    const bool adaptive;
+    const uint32_t minPrefetch;
+    const uint32_t maxPrefetch;
+
+    uint32_t prefetchMark;
+    uint32_t prefetchAmount;
+
+    co::QueueSlave::StealMode stealMode;
+
+private:
+    mutable lunchbox::SpinLock lock;
+    /** Unpacked CMD_QUEUE_ITEMS, filled from the receiver thread. */
+    std::deque< ICommand > items;
+    lunchbox::RNG rng;
+    lunchbox::Clock clock;
+    int32_t timedRequest; //!< the request measured for the RTT, or 0
+    float requestTime;
+    float returnTime; //!< time the last item was returned, or -1
+    float rtt;        //!< smoothed request round trip time in ms
+    float itemTime;   //!< smoothed consumer time per item in ms
+
+    static void _smooth( float& value, const float sample )
+    {
+        value = value > 0.f ? .875f * value + .125f * sample : sample;
+    }
+
+    void _adapt()
+    {
+        if( rtt <= 0.f || itemTime <= 0.f )
+            return;
+
+        const float items = rtt / std::max( itemTime, 0.001f ) + .5f;
+        const uint32_t target = items >= float( maxPrefetch ) ?
+                                    maxPrefetch : uint32_t( items );
+        prefetchMark = std::max( target, minPrefetch );
+        prefetchAmount = prefetchMark;
+    }
 };
 }
 
@@ -70,7 +269,13 @@ void QueueSlave::attach( const UUID& id, const uint32_t instanceID )
 {
     Object::attach(id, instanceID);
     registerCommand( CMD_QUEUE_ITEM, CommandFunc<Object>(0, 0), &_impl->queue );
+    registerCommand( CMD_QUEUE_ITEMS,
+                     CommandFunc< QueueSlave >( this, &QueueSlave::_cmdItems ),
+                     0 );
     registerCommand( CMD_QUEUE_EMPTY, CommandFunc<Object>(0, 0), &_impl->queue);
+    registerCommand( CMD_QUEUE_STEAL,
+                     CommandFunc< QueueSlave >( this, &QueueSlave::_cmdSteal ),
+                     getLocalNode()->getCommandThreadQueue( id ));
 }
 
 void QueueSlave::applyInstanceData( co::DataIStream& is )
@@ -84,43 +289,162 @@ void QueueSlave::applyInstanceData( co::DataIStream& is )
     _impl->master = localNode->connect( masterNodeID );
 }
 
+void QueueSlave::setStealMode( const StealMode mode )
+{
+    _impl->stealMode = mode;
+}
+
+QueueSlave::StealMode QueueSlave::getStealMode() const
+{
+    return _impl->stealMode;
+}
+
 ObjectICommand QueueSlave::pop( const uint32_t timeout )
 {
-    static lunchbox::a_int32_t _request;
     const int32_t request = ++_request;
+    int32_t expected = request; //!< the request answered by CMD_QUEUE_EMPTY
+    bool stealing = false;
 
+    _impl->popStarted();
     while( true )
     {
-        const size_t queueSize = _impl->queue.getSize();
-        if( queueSize <= _impl->prefetchMark )
+        const size_t load = _impl->getLoad();
+        if( !stealing && load <= _impl->prefetchMark )
         {
             send( _impl->master, CMD_QUEUE_GET_ITEM, _impl->masterInstanceID )
-                    << _impl->prefetchAmount << getInstanceID() << request;
+                    << _impl->prefetchAmount << getInstanceID() << request
+                    << uint32_t( load ) << ( _impl->stealMode != STEAL_NONE );
+            _impl->requested( request );
+        }
+
+        ICommand item;
+        if( _impl->popItem( item ))
+        {
+            _impl->popFinished();
+            return ObjectICommand( item );
         }
 
+        // write coalesced requests before waiting for the replies
+        ConnectionPtr connection = _impl->master->getConnection();
+        if( connection )
+            connection->flush();
+
+        // do not wait forever on a steal victim which may have left
+        const uint32_t wait = stealing ?
+            std::min( timeout, uint32_t( Global::getIAttribute(
+                                       Global::IATTR_QUEUE_STEAL_TIMEOUT ))) :
+            timeout;
         try
         {
-            ObjectICommand cmd( _impl->queue.pop( timeout ));
+            ObjectICommand cmd( _impl->queue.pop( wait ));
             switch( cmd.getCommand( ))
             {
             case CMD_QUEUE_ITEM:
+                _impl->popFinished();
                 return ObjectICommand( cmd );
 
+            case CMD_QUEUE_ITEMS: // unpacked by _cmdItems
+                _impl->replied( cmd.get< int32_t >( ));
+                break;
+
             default:
                 LBUNIMPLEMENTED;
             case CMD_QUEUE_EMPTY:
-                if( cmd.get< int32_t >() == request )
-                    return ObjectICommand( 0, 0, 0, false );
-                // else left-over or not our empty command, discard and retry
-                break;
+            {
+                const int32_t requestID = cmd.get< int32_t >();
+                _impl->replied( requestID );
+                if( requestID != expected )
+                    // left-over or not our empty command, discard and retry
+                    break;
+
+                if( !stealing ) // master is empty, try peers before giving up
+                {
+                    stealing = true;
+                    _impl->setVictims( cmd );
+                }
+                expected = _steal();
+                if( expected != 0 )
+                    break;
+                return ObjectICommand( 0, 0, 0, false );
+            }
             }
         }
         catch (co::Exception& e)
         {
+            if( stealing && wait < timeout ) // victim did not reply, next one
+            {
+                expected = _steal();
+                if( expected != 0 )
+                    continue;
+                return ObjectICommand( 0, 0, 0, false );
+            }
             LBWARN << e.what() << std::endl;
             return ObjectICommand( 0, 0, 0, false );
         }
     }
 }
 
+int32_t QueueSlave::_steal()
+{
+    if( _impl->stealMode == STEAL_NONE )
+        return 0;
+
+    LocalNodePtr localNode = getLocalNode();
+    while( !_impl->victims.empty( ))
+    {
+        const detail::QueueSlave::Peer victim = _impl->victims.front();
+        _impl->victims.pop_front();
+
+        NodePtr node = localNode->connect( victim.nodeID );
+        if( !node )
+            continue;
+
+        const int32_t request = ++_request;
+        send( node, CMD_QUEUE_STEAL, victim.instanceID )
+            << getInstanceID() << request << _impl->prefetchAmount;
+        return request;
+    }
+    return 0;
+}
+
+bool QueueSlave::_cmdItems( ICommand& cmd )
+{
+    // unpack on arrival, so that prefetched items are counted and stealable
+    ObjectICommand command( cmd );
+    command.get< int32_t >(); // request, evaluated by pop()
+    _impl->unpack( command );
+    _impl->queue.push( cmd );
+    return true;
+}
+
+bool QueueSlave::_cmdSteal( ICommand& cmd )
+{
+    ObjectICommand command( cmd );
+    const uint32_t instanceID = command.get< uint32_t >();
+    const int32_t requestID = command.get< int32_t >();
+    const uint32_t amount = command.get< uint32_t >();
+
+    const ICommands items = _impl->steal( amount );
+    NodePtr thief = command.getNode();
+    if( !items.empty( ))
+    {
+        const uint64_t headerSize = detail::getHeaderSize();
+        ObjectOCommand reply( send( thief, CMD_QUEUE_ITEMS, instanceID ));
+        reply << requestID << uint32_t( items.size( ));
+        for( ICommandsCIter i = items.begin(); i != items.end(); ++i )
+        {
+            ConstBufferPtr buffer = i->getBuffer();
+            const uint64_t size = buffer->getSize() - headerSize;
+            reply << size;
+            if( size > 0 )
+                reply << Array< const void >( buffer->getData() + headerSize,
+                                              size );
+        }
+    }
+
+    if( items.size() < amount )
+        send( thief, CMD_QUEUE_EMPTY, instanceID ) << requestID << uint32_t( 0 );
+    return true;
+}
+
 }
@@ -39,6 +39,14 @@ namespace detail { class QueueSlave; }
 class QueueSlave : public Object
 {
 public:
+    /** The peer selection when stealing items from other slaves. */
+    enum StealMode
+    {
+        STEAL_NONE,   //!< never steal, report an empty queue immediately
+        STEAL_RANDOM, //!< steal from randomly ordered peers
+        STEAL_LOAD    //!< steal from the peers with the most queued items first
+    };
+
     /**
      * Construct a new queue consumer.
      *
@@ -48,6 +56,12 @@ public:
      * hides the network latency by pipelining the network communication with
      * the processing, but introduces some imbalance between queue slaves.
      *
+     * If neither parameter is given, the slave adapts both values at runtime
+     * so that the local queue covers roughly one request round trip of
+     * processing. The values start at the Global IATTR_TILE_QUEUE_MIN_SIZE
+     * and IATTR_TILE_QUEUE_REFILL attributes and are bounded by
+     * IATTR_TILE_QUEUE_MIN_SIZE and IATTR_QUEUE_PREFETCH_MAX.
+     *
      * @param prefetchMark the low-water mark for prefetching, or
      *                     LB_UNDEFINED_UINT32 to use the Global default.
      * @param prefetchAmount the refill quantity when prefetching, or
@@ -73,6 +87,23 @@ public:
      */
     CO_API ObjectICommand pop( const uint32_t timeout = LB_TIMEOUT_INDEFINITE );
 
+    /**
+     * Set the work stealing mode of this slave.
+     *
+     * When the master queue is empty, a stealing slave takes prefetched items
+     * from other slaves of the same queue before pop() reports an empty queue.
+     * All slaves serve steal requests, regardless of their own mode. A victim
+     * which does not reply within the Global IATTR_QUEUE_STEAL_TIMEOUT is
+     * skipped.
+     *
+     * @param mode the victim selection, or STEAL_NONE to disable stealing.
+     * @version 1.1.1
+     */
+    CO_API void setStealMode( const StealMode mode );
+
+    /** @return the work stealing mode of this slave. @version 1.1.1 */
+    CO_API StealMode getStealMode() const;
+
 protected:
     ChangeType getChangeType() const override { return STATIC; }
     void getInstanceData( co::DataOStream& ) override { LBDONTCALL }
@@ -82,6 +113,13 @@ private:
     detail::QueueSlave* const _impl;
 
     CO_API void attach( const UUID& id, const uint32_t instanceID ) override;
+
+    /** Ask the next victim for items, @return the request or 0. */
+    int32_t _steal();
+
+    /* The command handlers. */
+    bool _cmdItems( ICommand& command );
+    bool _cmdSteal( ICommand& command );
 };
 
 } // co
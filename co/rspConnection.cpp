@@ -33,9 +33,23 @@
 #include <boost/thread.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <cmath>
+
 //#define CO_INSTRUMENT_RSP
 #define CO_RSP_MERGE_WRITES
 #define CO_RSP_MAX_TIMEOUTS 1000
+#define CO_RSP_MIN_SLEEP 50 // us, shorter waits yield instead of sleeping
+#ifdef __linux__
+#  define CO_RSP_BATCH_IO // recvmmsg, sendmmsg and UDP segmentation offload
+#  define CO_RSP_BATCH_SIZE 32 // datagrams per send or receive call
+#  define CO_RSP_MAX_SEND_RETRIES 100 // on full socket buffers
+#  include <errno.h>
+#  include <netinet/in.h>
+#  include <netinet/udp.h>
+#  include <sys/socket.h>
+#else
+#  define CO_RSP_BATCH_SIZE 1
+#endif
 #ifdef _WIN32
 #  define CO_RSP_DEFAULT_PORT (4242)
 #else
@@ -46,6 +60,9 @@
 // Note: Do not use version > 255, endianness detection magic relies on this.
 const uint16_t CO_RSP_PROTOCOL_VERSION = 0;
 
+// Size of an ack without the rate report, as sent by older readers.
+const size_t CO_RSP_ACK_SIZE = 4 * sizeof( uint16_t );
+
 namespace bp = boost::posix_time;
 namespace ip = boost::asio::ip;
 
@@ -69,6 +86,8 @@ lunchbox::a_int32_t nAcksAccepted;
 lunchbox::a_int32_t nNAcksSend;
 lunchbox::a_int32_t nNAcksRead;
 lunchbox::a_int32_t nNAcksResend;
+lunchbox::a_int32_t nParity;
+lunchbox::a_int32_t nRecovered;
 
 float writeWaitTime = 0.f;
 lunchbox::Clock instrumentClock;
@@ -96,6 +115,25 @@ RSPConnection::RSPConnection()
     , _acked( std::numeric_limits< uint16_t >::max( ))
     , _threadBuffers( Global::getIAttribute( Global::IATTR_RSP_NUM_BUFFERS))
     , _recvBuffer( _mtu )
+    , _useSegmentation( true )
+    , _acksPending( false )
+    , _lost( 0 )
+    , _parityBlock( 0 )
+    , _parity( _mtu )
+    , _parityBuffer( _mtu )
+    , _rtt( 0.f )
+    , _rttSequence( 0 )
+    , _rttPending( false )
+    , _reportsPending( false )
+    , _rateControl( false )
+    , _reporting( false )
+    , _readerRate( 0 )
+    , _readerLoss( 0.f )
+    , _reportBytes( 0 )
+    , _reportDatagrams( 0 )
+    , _reportLost( 0 )
+    , _nDataRead( 0 )
+    , _testLoss( 0 )
     , _readBuffer( 0 )
     , _readBufferPos( 0 )
     , _sequence( 0 )
@@ -115,6 +153,25 @@ RSPConnection::RSPConnection()
     {
         _buffers.push_back( new Buffer( _mtu ));
     }
+#ifdef CO_RSP_BATCH_IO
+    // the first datagram of a batch is received in _recvBuffer
+    for( size_t i = 1; i < CO_RSP_BATCH_SIZE; ++i )
+        _recvBatch.push_back( new Buffer( _mtu ));
+#endif
+
+    const int32_t parityBlock =
+        Global::getIAttribute( Global::IATTR_RSP_PARITY_BLOCK );
+    if( parityBlock > 1 )
+    {
+        // Blocks are aligned to sequence numbers, use a power of two
+        _parityBlock = 2;
+        while( _parityBlock < 256 &&
+               int32_t( _parityBlock << 1 ) <= parityBlock )
+        {
+            _parityBlock <<= 1;
+        }
+        _payloadSize = _mtu - sizeof( DatagramParity );
+    }
 
     LBASSERT( sizeof( DatagramNack ) <= size_t( _mtu ));
     LBLOG( LOG_RSP ) << "New RSP connection, " << _buffers.size()
@@ -130,6 +187,11 @@ RSPConnection::~RSPConnection()
         delete _buffers.back();
         _buffers.pop_back();
     }
+    while( !_recvBatch.empty( ))
+    {
+        delete _recvBatch.back();
+        _recvBatch.pop_back();
+    }
 }
 
 void RSPConnection::_close()
@@ -212,6 +274,10 @@ bool RSPConnection::listen()
 
     _setState( STATE_CONNECTING );
     _numBuffers =  Global::getIAttribute( Global::IATTR_RSP_NUM_BUFFERS );
+    _rateControl =
+        Global::getIAttribute( Global::IATTR_RSP_RATE_CONTROL ) != 0;
+    const int32_t loss = Global::getIAttribute( Global::IATTR_RSP_TEST_LOSS );
+    _testLoss = loss > 0 ? uint32_t( loss ) : 0;
 
     // init udp connection
     if( description->port == 0 )
@@ -276,8 +342,14 @@ bool RSPConnection::listen()
 
         _write->connect( writeEndpoint );
 
-        _read->set_option( ip::multicast::enable_loopback( false ));
-        _write->set_option( ip::multicast::enable_loopback( false ));
+        // Loopback allows group members on the same host, e.g., for tests.
+        // Our own datagrams are recognized by the source of the write socket.
+        const bool loopback =
+            Global::getIAttribute( Global::IATTR_RSP_MULTICAST_LOOPBACK ) > 0;
+        _read->set_option( ip::multicast::enable_loopback( loopback ));
+        _write->set_option( ip::multicast::enable_loopback( loopback ));
+        if( loopback )
+            _writeAddr = _write->local_endpoint();
     }
     catch( const boost::system::system_error& e )
     {
@@ -611,6 +683,7 @@ void RSPConnection::_processOutgoing()
     }
 #endif
 
+    _processFeedback();
     if( !_repeatQueue.empty( ))
         _repeatData();
     else
@@ -650,65 +723,83 @@ void RSPConnection::_processOutgoing()
 
 void RSPConnection::_writeData()
 {
-    Buffer* buffer = 0;
-    if( !_threadBuffers.pop( buffer )) // nothing to write
-        return;
+    bool written = false;
+    for( size_t i = 0; i < CO_RSP_BATCH_SIZE; ++i )
+    {
+        Buffer* buffer = 0;
+        if( !_threadBuffers.pop( buffer )) // nothing (more) to write
+            break;
 
-    _timeouts = 0;
-    LBASSERT( buffer );
+        _timeouts = 0;
+        LBASSERT( buffer );
 
-    // write buffer
-    DatagramData* header = reinterpret_cast<DatagramData*>( buffer->getData( ));
-    header->sequence = _sequence++;
+        // write buffer
+        DatagramData* header =
+            reinterpret_cast< DatagramData* >( buffer->getData( ));
+        header->sequence = _sequence++;
 
 #ifdef CO_RSP_MERGE_WRITES
-    if( header->size < _payloadSize && !_threadBuffers.isEmpty( ))
-    {
-        std::vector< Buffer* > appBuffers;
-        while( header->size < _payloadSize && !_threadBuffers.isEmpty( ))
+        if( header->size < _payloadSize && !_threadBuffers.isEmpty( ))
         {
-            Buffer* buffer2 = 0;
-            LBCHECK( _threadBuffers.getFront( buffer2 ));
-            LBASSERT( buffer2 );
-            DatagramData* header2 =
-                reinterpret_cast<DatagramData*>( buffer2->getData( ));
-
-            if( uint32_t( header->size + header2->size ) > _payloadSize )
-                break;
-
-            memcpy( reinterpret_cast<uint8_t*>( header + 1 ) + header->size,
-                    header2 + 1, header2->size );
-            header->size += header2->size;
-            LBCHECK( _threadBuffers.pop( buffer2 ));
-            appBuffers.push_back( buffer2 );
+            std::vector< Buffer* > appBuffers;
+            while( header->size < _payloadSize && !_threadBuffers.isEmpty( ))
+            {
+                Buffer* buffer2 = 0;
+                LBCHECK( _threadBuffers.getFront( buffer2 ));
+                LBASSERT( buffer2 );
+                DatagramData* header2 =
+                    reinterpret_cast<DatagramData*>( buffer2->getData( ));
+
+                if( uint32_t( header->size + header2->size ) > _payloadSize )
+                    break;
+
+                memcpy( reinterpret_cast< uint8_t* >( header + 1 ) +
+                        header->size, header2 + 1, header2->size );
+                header->size += header2->size;
+                LBCHECK( _threadBuffers.pop( buffer2 ));
+                appBuffers.push_back( buffer2 );
 #ifdef CO_INSTRUMENT_RSP
-            ++nMergedDatagrams;
+                ++nMergedDatagrams;
 #endif
-        }
+            }
 
-        if( !appBuffers.empty( ))
-            _appBuffers.push( appBuffers );
-    }
+            if( !appBuffers.empty( ))
+                _appBuffers.push( appBuffers );
+        }
 #endif
 
-    // send data
-    //  Note 1: We could optimize the send away if we're all alone, but this is
-    //          not a use case for RSP, so we don't care.
-    //  Note 2: Data to myself will be 'written' in _finishWriteQueue once we
-    //          got all acks for the packet
-    const uint32_t size = header->size + sizeof( DatagramData );
-
-    _waitWritable( size ); // OPT: process incoming in between
-    header->byteswap();
-    _write->send( boost::asio::buffer( header, size ));
+        // queue data
+        //  Note 1: We could optimize the send away if we're all alone, but
+        //          this is not a use case for RSP, so we don't care.
+        //  Note 2: Data to myself will be 'written' in _finishWriteQueue once
+        //          we got all acks for the packet
+        const uint32_t size = header->size + sizeof( DatagramData );
 
+        _waitWritable( size ); // OPT: process incoming in between
 #ifdef CO_INSTRUMENT_RSP
-    ++nDatagrams;
-    nBytesWritten += header->size;
+        ++nDatagrams;
+        nBytesWritten += header->size;
 #endif
+        {
+            lunchbox::ScopedFastWrite mutex( _statistics );
+            ++_statistics->datagramsSent;
+            _statistics->bytesSent += size;
+        }
+        const bool blockDone = _parityBlock && _addParity( *header );
+        header->byteswap();
+        _queueSend( header, size );
+
+        // save datagram for repeats (and self)
+        _writeBuffers.push_back( buffer );
+        written = true;
 
-    // save datagram for repeats (and self)
-    _writeBuffers.push_back( buffer );
+        if( blockDone )
+            _writeParity();
+    }
+
+    if( !written )
+        return;
+    _flushSends();
 
     if( _children.size() == 1 ) // We're all alone
     {
@@ -730,9 +821,16 @@ void RSPConnection::_waitWritable( const uint64_t bytes )
     const uint64_t size = LB_MIN( bytes, static_cast< uint64_t >( _mtu ));
     while( _bucketSize < size )
     {
-        lunchbox::Thread::yield();
-        float time = _clock.resetTimef();
+        // Sleep until the bucket holds enough tokens to depart. Oversleeping
+        // is compensated by the refill using the elapsed time.
+        const int64_t wait = int64_t( size - _bucketSize ) * 1000 /
+                             LB_MAX( _sendRate, int64_t( 1 ));
+        if( wait >= CO_RSP_MIN_SLEEP )
+            boost::this_thread::sleep( bp::microseconds( wait ));
+        else
+            lunchbox::Thread::yield();
 
+        float time = _clock.resetTimef();
         while( time == 0.f )
         {
             lunchbox::Thread::yield();
@@ -748,17 +846,36 @@ void RSPConnection::_waitWritable( const uint64_t bytes )
     writeWaitTime += clock.getTimef();
 #endif
 
+    if( _useReports( ))
+        return; // adapted from reader reports in _adaptSendRate
+
     ConstConnectionDescriptionPtr description = getDescription();
     if( _sendRate < description->bandwidth )
     {
         _sendRate += int64_t(
             float( Global::getIAttribute( Global::IATTR_RSP_ERROR_UPSCALE )) *
             float( description->bandwidth ) * .001f );
+        _countRateChange( true );
         LBLOG( LOG_RSP ) << "speeding up to " << _sendRate << " KB/s"
                          << std::endl;
     }
 }
 
+RSPConnection::Statistics RSPConnection::getStatistics() const
+{
+    lunchbox::ScopedFastRead mutex( _statistics );
+    return _statistics.data;
+}
+
+void RSPConnection::_countRateChange( const bool increase )
+{
+    lunchbox::ScopedFastWrite mutex( _statistics );
+    if( increase )
+        ++_statistics->rateIncreases;
+    else
+        ++_statistics->rateDecreases;
+}
+
 void RSPConnection::_repeatData()
 {
     _timeouts = 0;
@@ -790,13 +907,16 @@ void RSPConnection::_repeatData()
             const uint32_t size = header->size + sizeof( DatagramData );
             LBASSERT( header->sequence == request.start );
 
-            // send data
+            // queue data
             _waitWritable( size ); // OPT: process incoming in between
             // already done by _writeData: header->byteswap();
-            _write->send( boost::asio::buffer( header, size ) );
+            _queueSend( header, size );
 #ifdef CO_INSTRUMENT_RSP
             ++nRepeated;
 #endif
+            lunchbox::ScopedFastWrite mutex( _statistics );
+            ++_statistics->datagramsRepeated;
+            _statistics->bytesSent += size;
         }
 
         if( request.start == request.end )
@@ -804,9 +924,173 @@ void RSPConnection::_repeatData()
         else
             ++request.start;
 
-        if( distance <= _writeBuffers.size( )) // send something
-            return;
+        if( _sendQueue.size() >= CO_RSP_BATCH_SIZE ) // send batch
+            break;
     }
+    _flushSends();
+}
+
+void RSPConnection::_queueSend( const void* data, const size_t size )
+{
+    _sendQueue.push_back( boost::asio::buffer( data, size ));
+}
+
+void RSPConnection::_flushSends()
+{
+    const size_t nDatagrams = _sendQueue.size();
+#ifdef CO_RSP_BATCH_IO
+    const int fd = _write->native_handle();
+    size_t i = 0;
+    size_t nRetries = 0;
+    while( i < nDatagrams )
+    {
+#  ifdef UDP_SEGMENT
+        // Full-sized datagrams are segmented by the kernel from one send
+        size_t end = i;
+        const size_t maxEnd = i + LB_MIN( CO_RSP_BATCH_SIZE, 65000 / _mtu );
+        while( end < nDatagrams && end < maxEnd &&
+               boost::asio::buffer_size( _sendQueue[ end ]) == size_t( _mtu ))
+        {
+            ++end;
+        }
+        if( end < nDatagrams && end < maxEnd ) // last segment may be smaller
+            ++end;
+
+        if( _useSegmentation && end - i > 1 )
+        {
+            if( _sendSegmented( i, end ))
+            {
+                i = end;
+                continue;
+            }
+            // Only a rejected UDP_SEGMENT request disables the offload, other
+            // errors are transient and handled by the plain send below.
+            if( errno == EIO || errno == EINVAL )
+            {
+                LBINFO << "UDP segmentation offload not usable: "
+                       << lunchbox::sysError << std::endl;
+                _useSegmentation = false;
+            }
+        }
+#  endif
+        mmsghdr msgs[ CO_RSP_BATCH_SIZE ];
+        iovec iovecs[ CO_RSP_BATCH_SIZE ];
+        const size_t n = LB_MIN( nDatagrams - i, size_t( CO_RSP_BATCH_SIZE ));
+        ::memset( msgs, 0, sizeof( msgs ));
+        for( size_t j = 0; j < n; ++j )
+        {
+            const boost::asio::const_buffer& buffer = _sendQueue[ i + j ];
+            iovecs[j].iov_base = const_cast< void* >(
+                boost::asio::buffer_cast< const void* >( buffer ));
+            iovecs[j].iov_len = boost::asio::buffer_size( buffer );
+            msgs[j].msg_hdr.msg_iov = &iovecs[j];
+            msgs[j].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int sent = ::sendmmsg( fd, msgs, unsigned( n ), 0 );
+        if( sent > 0 )
+        {
+            i += sent;
+            nRetries = 0;
+            continue;
+        }
+
+        if( sent < 0 && errno == EINTR )
+            continue;
+        if(( sent == 0 || errno == EAGAIN || errno == EWOULDBLOCK ||
+             errno == ENOBUFS ) && ++nRetries < CO_RSP_MAX_SEND_RETRIES )
+        {
+            lunchbox::Thread::yield();
+            continue;
+        }
+
+        // skip the failing datagram, it is repeated upon nack, and keep
+        // sending the remainder
+        if( sent < 0 )
+            LBWARN << "Error during send: " << lunchbox::sysError << std::endl;
+        else
+            LBWARN << "Error during send: no datagram sent" << std::endl;
+        ++i;
+        nRetries = 0;
+    }
+#else
+    for( size_t i = 0; i < nDatagrams; ++i )
+        _write->send( boost::asio::buffer( _sendQueue[i] ));
+#endif
+    _sendQueue.clear();
+}
+
+#if defined( CO_RSP_BATCH_IO ) && defined( UDP_SEGMENT )
+bool RSPConnection::_sendSegmented( const size_t begin, const size_t end )
+{
+    iovec iovecs[ CO_RSP_BATCH_SIZE ];
+    LBASSERT( end - begin <= CO_RSP_BATCH_SIZE );
+    for( size_t i = begin; i < end; ++i )
+    {
+        const boost::asio::const_buffer& buffer = _sendQueue[ i ];
+        iovecs[ i - begin ].iov_base = const_cast< void* >(
+            boost::asio::buffer_cast< const void* >( buffer ));
+        iovecs[ i - begin ].iov_len = boost::asio::buffer_size( buffer );
+    }
+
+    char control[ CMSG_SPACE( sizeof( uint16_t )) ];
+    ::memset( control, 0, sizeof( control ));
+
+    msghdr msg;
+    ::memset( &msg, 0, sizeof( msg ));
+    msg.msg_iov = iovecs;
+    msg.msg_iovlen = end - begin;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof( control );
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN( sizeof( uint16_t ));
+    *reinterpret_cast< uint16_t* >( CMSG_DATA( cmsg )) = uint16_t( _mtu );
+
+    return ::sendmsg( _write->native_handle(), &msg, 0 ) >= 0;
+}
+#else
+bool RSPConnection::_sendSegmented( const size_t, const size_t )
+{
+    return false;
+}
+#endif
+
+bool RSPConnection::_addParity( const DatagramData& datagram )
+{
+    const uint16_t first = datagram.sequence & ~uint16_t( _parityBlock - 1 );
+    if( datagram.sequence == first || _parity.getSequence() != first )
+        _parity.reset( first );
+
+    _parity.add( &datagram + 1, datagram.size );
+    return _parity.getCount() == _parityBlock;
+}
+
+void RSPConnection::_writeParity()
+{
+    if( _children.size() == 1 ) // We're all alone
+        return;
+
+    DatagramParity* header =
+        reinterpret_cast< DatagramParity* >( _parityBuffer.getData( ));
+    header->type = PARITY;
+    header->sizes = _parity.getSizes();
+    header->writerID = _id;
+    header->sequence = _parity.getSequence();
+    header->count = _parity.getCount();
+    header->pad = 0;
+    ::memcpy( header + 1, _parity.getData(), _parity.getLength( ));
+
+    const uint32_t size = _parity.getLength() + sizeof( DatagramParity );
+    _waitWritable( size );
+    header->byteswap();
+    _queueSend( header, size );
+    _flushSends(); // _parityBuffer is reused for the next block
+#ifdef CO_INSTRUMENT_RSP
+    ++nParity;
+#endif
 }
 
 void RSPConnection::_finishWriteQueue( const uint16_t sequence )
@@ -893,9 +1177,18 @@ void RSPConnection::_finishWriteQueue( const uint16_t sequence )
 void RSPConnection::_handlePacket( const boost::system::error_code& /* error */,
                                    const size_t bytes )
 {
+    if( _readAddr == _writeAddr ) // own datagram on multicast loopback
+    {
+        _asyncReceiveFrom();
+        return;
+    }
+
     if( isListening( ))
     {
         _handleConnectedData( bytes );
+#ifdef CO_RSP_BATCH_IO
+        _receiveBatch();
+#endif
 
         if( isListening( ))
             _processOutgoing();
@@ -917,6 +1210,48 @@ void RSPConnection::_handlePacket( const boost::system::error_code& /* error */,
     _asyncReceiveFrom();
 }
 
+void RSPConnection::_receiveBatch()
+{
+#ifdef CO_RSP_BATCH_IO
+    // Drain datagrams already queued on the socket with one system call
+    const size_t nBuffers = _recvBatch.size();
+    if( nBuffers == 0 )
+        return;
+
+    mmsghdr msgs[ CO_RSP_BATCH_SIZE ];
+    iovec iovecs[ CO_RSP_BATCH_SIZE ];
+    sockaddr_in addrs[ CO_RSP_BATCH_SIZE ];
+    ::memset( msgs, 0, sizeof( msgs ));
+    for( size_t i = 0; i < nBuffers; ++i )
+    {
+        iovecs[i].iov_base = _recvBatch[i]->getData();
+        iovecs[i].iov_len = _recvBatch[i]->getMaxSize();
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof( sockaddr_in );
+    }
+
+    const int received = ::recvmmsg( _read->native_handle(), msgs,
+                                     unsigned( nBuffers ), MSG_DONTWAIT, 0 );
+    for( int i = 0; i < received && isListening(); ++i )
+    {
+        // own datagram on multicast loopback, see listen()
+        if( addrs[i].sin_port == htons( _writeAddr.port( )) &&
+            addrs[i].sin_addr.s_addr ==
+                htonl( _writeAddr.address().to_v4().to_ulong( )))
+        {
+            continue;
+        }
+
+        // _handleConnectedData may swap _recvBuffer with a pooled buffer
+        _recvBuffer.swap( *_recvBatch[i] );
+        _handleConnectedData( msgs[i].msg_len );
+        _recvBuffer.swap( *_recvBatch[i] );
+    }
+#endif
+}
+
 void RSPConnection::_handleAcceptIDData( const size_t bytes )
 {
     DatagramNode* pNode = _getDatagramNode( bytes );
@@ -1009,8 +1344,13 @@ void RSPConnection::_handleConnectedData( const size_t bytes )
     switch( type )
     {
         case DATA:
+        {
+            // simulated loss for testing, see Global::IATTR_RSP_TEST_LOSS
+            if( _testLoss > 0 && ( ++_nDataRead % _testLoss ) == 0 )
+                break;
             LBCHECK( _handleData( bytes ));
             break;
+        }
 
         case ACK:
             LBCHECK( _handleAck( bytes ));
@@ -1020,6 +1360,10 @@ void RSPConnection::_handleConnectedData( const size_t bytes )
             LBCHECK( _handleNack( ));
             break;
 
+        case PARITY:
+            LBCHECK( _handleParity( bytes ));
+            break;
+
         case ACKREQ: // The writer asks for an ack/nack
             LBCHECK( _handleAckRequest( bytes ));
             break;
@@ -1082,6 +1426,10 @@ bool RSPConnection::_handleData( const size_t bytes )
     const uint16_t sequence = datagram.sequence;
 //  LBLOG( LOG_RSP ) << "rcvd " << sequence << " from " << writerID <<std::endl;
 
+    if( connection->_reportDatagrams++ == 0 ) // measure from first datagram
+        connection->_reportClock.reset();
+    connection->_reportBytes += bytes;
+
     if( connection->_sequence == sequence ) // in-order packet
     {
         Buffer* newBuffer = connection->_newDataBuffer( _recvBuffer );
@@ -1137,8 +1485,16 @@ bool RSPConnection::_handleData( const size_t bytes )
     if( !newBuffer ) // no more data buffers, drop packet
         return true;
 
-    if( connection->_recvBuffers.size() < size )
+    // Count the datagrams skipped since the highest one received so far as
+    // lost, so that each gap is reported once when it opens. _sequence is
+    // missing as well if nothing was received out of order yet.
+    const size_t received = connection->_recvBuffers.size();
+    if( received < size )
+    {
+        connection->_reportLost += uint32_t( size - received ) - 1 +
+                                   ( received == 0 ? 1 : 0 );
         connection->_recvBuffers.resize( size, 0 );
+    }
 
     LBASSERT( !connection->_recvBuffers[ i ] );
     connection->_recvBuffers[ i ] = newBuffer;
@@ -1161,6 +1517,12 @@ bool RSPConnection::_handleData( const size_t bytes )
         }
     }
 
+    if( connection->_isRecoverable( sequence ))
+    {
+        // single loss, wait for the parity of the block to recover it
+        return true;
+    }
+
     LBLOG( LOG_RSP ) << "send early nack " << nack.start << ".." << nack.end
                      << " current " << connection->_sequence << " ooo "
                      << connection->_recvBuffers.size() << std::endl;
@@ -1173,6 +1535,33 @@ bool RSPConnection::_handleData( const size_t bytes )
     return true;
 }
 
+bool RSPConnection::_isRecoverable( const uint16_t sequence ) const
+{
+    if( !_parityBlock )
+        return false;
+
+    // all earlier blocks have to be complete or recovered by now
+    const uint16_t blockStart = sequence & ~uint16_t( _parityBlock - 1 );
+    if( uint16_t( sequence - _sequence ) > uint16_t( sequence - blockStart ))
+        return false;
+
+    // count the datagrams of the block missing before the given one
+    size_t nMissing = 0;
+    for( uint16_t i = blockStart; i != sequence; ++i )
+    {
+        const uint16_t distance = i - _sequence;
+        if( distance > uint16_t( sequence - _sequence ))
+            continue; // delivered already
+
+        if( distance == 0 || distance > _recvBuffers.size() ||
+            !_recvBuffers[ distance - 1 ] )
+        {
+            ++nMissing;
+        }
+    }
+    return nMissing == 1;
+}
+
 RSPConnection::Buffer* RSPConnection::_newDataBuffer( Buffer& inBuffer )
 {
     LBASSERT( static_cast< int32_t >( inBuffer.getMaxSize( )) == _mtu );
@@ -1201,11 +1590,13 @@ RSPConnection::Buffer* RSPConnection::_newDataBuffer( Buffer& inBuffer )
 void RSPConnection::_pushDataBuffer( Buffer* buffer )
 {
     LBASSERT( _parent );
-#ifndef NDEBUG
-    DatagramData* dgram = reinterpret_cast< DatagramData* >(buffer->getData( ));
+    const DatagramData* dgram =
+        reinterpret_cast< const DatagramData* >( buffer->getData( ));
     LBASSERTINFO( dgram->sequence == _sequence,
                   dgram->sequence << " != " << _sequence );
-#endif
+
+    if( _parityBlock ) // in-order datagrams of the current block
+        _addParity( *dgram );
 
     if( (( _sequence + _parent->_id ) % _ackFreq ) == 0 )
         _parent->_sendAck( _id, _sequence );
@@ -1217,7 +1608,7 @@ void RSPConnection::_pushDataBuffer( Buffer* buffer )
 
 bool RSPConnection::_handleAck( const size_t bytes )
 {
-    if( bytes < sizeof( DatagramAck ))
+    if( bytes < CO_RSP_ACK_SIZE )
         return false;
     DatagramAck& ack =
                      *reinterpret_cast< DatagramAck* >( _recvBuffer.getData( ));
@@ -1242,6 +1633,24 @@ bool RSPConnection::_handleAck( const size_t bytes )
         return false;
     }
 
+    if( _rttPending && ack.sequence == _rttSequence )
+    {
+        const float rtt = _rttClock.getTimef();
+        _rtt = ( _rtt == 0.f ) ? rtt : _rtt + ( rtt - _rtt ) * .125f;
+        _rttPending = false;
+    }
+
+    // reader report for rate control
+    if( bytes >= sizeof( DatagramAck ))
+    {
+        if( ack.rate > 0 )
+            connection->_readerRate = ack.rate;
+        connection->_readerLoss += ( float( ack.loss ) * .001f -
+                                     connection->_readerLoss ) * .25f;
+        connection->_reporting = true;
+        _reportsPending = true;
+    }
+
     if( connection->_acked >= ack.sequence &&
         connection->_acked - ack.sequence <= _numBuffers )
     {
@@ -1253,27 +1662,13 @@ bool RSPConnection::_handleAck( const size_t bytes )
 #ifdef CO_INSTRUMENT_RSP
     ++nAcksAccepted;
 #endif
-    connection->_acked = ack.sequence;
-    _timeouts = 0; // reset timeout counter
-
-    // Check if we can advance _acked
-    uint16_t acked = ack.sequence;
-
-    for( RSPConnectionsCIter i = _children.begin(); i != _children.end(); ++i )
     {
-        RSPConnectionPtr child = *i;
-        if( child->_id == _id )
-            continue;
-
-        const uint16_t distance = child->_acked - acked;
-        if( distance > _numBuffers )
-            acked = child->_acked;
+        lunchbox::ScopedFastWrite mutex( _statistics );
+        ++_statistics->acksReceived;
     }
-
-    RSPConnectionPtr selfChild = _findConnection( _id );
-    const uint16_t distance = acked - selfChild->_acked;
-    if( distance <= _numBuffers )
-        _finishWriteQueue( acked );
+    connection->_acked = ack.sequence;
+    _timeouts = 0; // reset timeout counter
+    _acksPending = true; // advance write queue once for all received acks
     return true;
 }
 
@@ -1308,6 +1703,10 @@ bool RSPConnection::_handleNack()
     }
 
     _timeouts = 0;
+    {
+        lunchbox::ScopedFastWrite mutex( _statistics );
+        ++_statistics->nacksReceived;
+    }
     _addRepeat( nack.nacks, nack.count );
     return true;
 }
@@ -1355,24 +1754,257 @@ void RSPConnection::_addRepeat( const Nack* nacks, uint16_t num )
         }
     }
 
+    _lost += lost; // send rate is adapted once for all received nacks
+    LBLOG( LOG_RSP ) << ", lost " << lost << std::endl
+                     << lunchbox::enableFlush;
+}
+
+void RSPConnection::_processFeedback()
+{
+    if( _acksPending && !_writeBuffers.empty( ))
+    {
+        // Check if we can advance _acked to the oldest ack of all readers
+        RSPConnectionPtr selfChild = _findConnection( _id );
+        uint16_t acked = 0;
+        bool found = false;
+
+        for( RSPConnectionsCIter i = _children.begin();
+             i != _children.end(); ++i )
+        {
+            RSPConnectionPtr child = *i;
+            if( child->_id == _id )
+                continue;
+
+            const uint16_t distance = child->_acked - acked;
+            if( !found || distance > _numBuffers )
+                acked = child->_acked;
+            found = true;
+        }
+
+        const uint16_t distance = acked - selfChild->_acked;
+        if( found && distance <= _numBuffers )
+            _finishWriteQueue( acked );
+    }
+    _acksPending = false;
+    if( _writeBuffers.empty( ))
+        _rttPending = false; // no ack for the timed ack request needed
+
+    if( _useReports( ))
+    {
+        _lost = 0;
+        if( _reportsPending )
+            _adaptSendRate();
+        return;
+    }
+
+    if( _lost == 0 )
+        return;
+
     ConstConnectionDescriptionPtr description = getDescription();
     if( _sendRate >
         ( description->bandwidth >>
           Global::getIAttribute( Global::IATTR_RSP_MIN_SENDRATE_SHIFT )))
     {
-        const float delta = float( lost ) * .001f *
+        const float delta = float( _lost ) * .001f *
                      Global::getIAttribute( Global::IATTR_RSP_ERROR_DOWNSCALE );
         const float maxDelta = .01f *
             float( Global::getIAttribute( Global::IATTR_RSP_ERROR_MAXSCALE ));
         const float downScale = LB_MIN( delta, maxDelta );
         _sendRate -= 1 + int64_t( _sendRate * downScale );
-        LBLOG( LOG_RSP )
-            << ", lost " << lost << " slowing down " << downScale * 100.f
-            << "% to " << _sendRate << " KB/s" << std::endl
-            << lunchbox::enableFlush;
+        _countRateChange( false );
+        LBLOG( LOG_RSP ) << "lost " << _lost << " slowing down "
+                         << downScale * 100.f << "% to " << _sendRate
+                         << " KB/s" << std::endl;
     }
-    else
-        LBLOG( LOG_RSP ) << std::endl << lunchbox::enableFlush;
+    _lost = 0;
+}
+
+bool RSPConnection::_useReports() const
+{
+    if( !_rateControl )
+        return false;
+
+    // Readers of older versions send no reports, use the loss-based control
+    // unless all readers report.
+    bool reports = false;
+    for( RSPConnectionsCIter i = _children.begin(); i != _children.end(); ++i )
+    {
+        const RSPConnection* child = i->get();
+        if( child->_id == _id )
+            continue;
+        if( !child->_reporting )
+            return false;
+        reports = true;
+    }
+    return reports;
+}
+
+void RSPConnection::_adaptSendRate()
+{
+    _reportsPending = false;
+
+    // The allowed rate of each reader is twice its receive rate, limited by
+    // the TFRC throughput equation (RFC 5348) if it reports loss.
+    const float rtt = _rtt > 0.f ? _rtt :
+        float( Global::getIAttribute( Global::IATTR_RSP_ACK_TIMEOUT ));
+    const float size = float( _mtu );
+    RSPConnectionPtr slowest;
+    int64_t target = std::numeric_limits< int64_t >::max();
+
+    for( RSPConnectionsCIter i = _children.begin(); i != _children.end(); ++i )
+    {
+        RSPConnectionPtr child = *i;
+        if( child->_id == _id || child->_readerRate == 0 )
+            continue;
+
+        int64_t allowed = 2 * child->_readerRate;
+        const float p = child->_readerLoss;
+        if( p > .0001f )
+        {
+            const float rto = 4.f * rtt;
+            const float rate = size / ( rtt * std::sqrt( 2.f * p / 3.f ) +
+                                        rto * 3.f * std::sqrt( 3.f * p / 8.f ) *
+                                        p * ( 1.f + 32.f * p * p ));
+            allowed = LB_MIN( allowed, int64_t( rate )); // B/ms ~= KB/s
+        }
+        if( allowed < target )
+        {
+            target = allowed;
+            slowest = child;
+        }
+    }
+
+    if( !slowest )
+        return;
+
+    ConstConnectionDescriptionPtr description = getDescription();
+    const int64_t minRate = description->bandwidth >>
+             Global::getIAttribute( Global::IATTR_RSP_MIN_SENDRATE_SHIFT );
+    target = LB_MAX( minRate, LB_MIN( target, description->bandwidth ));
+
+    // Smooth towards the target, back off faster than speeding up
+    const int64_t oldRate = _sendRate;
+    if( target < _sendRate )
+    {
+        _sendRate -= ( _sendRate - target + 1 ) / 2;
+        _countRateChange( false );
+    }
+    else if( target > _sendRate )
+    {
+        _sendRate += ( target - _sendRate + 7 ) / 8;
+        _countRateChange( true );
+    }
+
+    {
+        lunchbox::ScopedFastWrite mutex( _statistics );
+        _statistics->slowestRate = slowest->_readerRate;
+        _statistics->loss = slowest->_readerLoss;
+        _statistics->rtt = _rtt;
+    }
+    LBLOG( LOG_RSP ) << "reader " << slowest->_id << " receives "
+                     << slowest->_readerRate << " KB/s, loss "
+                     << slowest->_readerLoss << ", rtt " << _rtt
+                     << " ms: send rate " << oldRate << " -> " << _sendRate
+                     << " KB/s" << std::endl;
+}
+
+bool RSPConnection::_handleParity( const size_t bytes )
+{
+    if( bytes < sizeof( DatagramParity ))
+        return false;
+    DatagramParity& parity =
+                  *reinterpret_cast< DatagramParity* >( _recvBuffer.getData( ));
+    parity.byteswap();
+
+    if( parity.writerID == _id ) // see _handleData
+        return true;
+
+    RSPConnectionPtr connection = _findConnection( parity.writerID );
+    if( !connection )
+    {
+        LBUNREACHABLE;
+        return false;
+    }
+
+    const uint16_t count = parity.count;
+    if( count < 2 || ( count & ( count - 1 )) != 0 ||
+        ( parity.sequence & ( count - 1 )) != 0 || count > _numBuffers )
+    {
+        LBWARN << "Ignoring invalid parity block " << parity.sequence << "+"
+               << count << std::endl;
+        return true;
+    }
+    connection->_parityBlock = count;
+
+    // Single loss in this block: all previous datagrams have been pushed
+    // and are in the parity, all following ones are out-of-order buffers.
+    const uint16_t missing = connection->_sequence;
+    const uint16_t index = missing - parity.sequence;
+    if( index >= count ) // block complete or earlier datagrams missing
+        return true;
+
+    RSPParity& received = connection->_parity;
+    if( index == 0 )
+        received.reset( parity.sequence );
+    if( received.getSequence() != parity.sequence ||
+        received.getCount() != index )
+    {
+        return true; // started reading within block
+    }
+
+    const size_t nFollowing = count - index - 1;
+    std::deque< Buffer* >& following = connection->_recvBuffers;
+    for( size_t i = 0; i < nFollowing; ++i )
+    {
+        if( i < following.size() && following[i] )
+            continue;
+
+        // not recoverable (yet), fall back to repeat
+        Nack nack = { missing, uint16_t( missing + i ) };
+        if( nack.end < nack.start )
+            nack.end = std::numeric_limits< uint16_t >::max();
+        LBLOG( LOG_RSP ) << "Can't recover " << nack.start << ".." << nack.end
+                         << " from parity, send nack" << std::endl;
+        _sendNack( parity.writerID, &nack, 1 );
+        return true;
+    }
+
+    for( size_t i = 0; i < nFollowing; ++i )
+    {
+        const DatagramData* datagram =
+            reinterpret_cast< const DatagramData* >( following[i]->getData( ));
+        received.add( datagram + 1, datagram->size );
+    }
+
+    uint8_t* payload = reinterpret_cast< uint8_t* >( &parity + 1 );
+    const uint32_t length = uint32_t( bytes - sizeof( DatagramParity ));
+    uint16_t size = parity.sizes;
+    if( received.getLength() <= length )
+        received.apply( payload, length, size );
+
+    if( received.getLength() > length || size > length )
+    {
+        LBWARN << "Parity block " << parity.sequence << " from "
+               << parity.writerID << " does not match received data"
+               << std::endl;
+        return true;
+    }
+
+    // Transform parity into the missing datagram and process it
+    DatagramData* datagram = reinterpret_cast< DatagramData* >( &parity );
+    ::memmove( datagram + 1, payload, size );
+    datagram->type = DATA;
+    datagram->size = size;
+    datagram->writerID = connection->_id;
+    datagram->sequence = missing;
+    datagram->byteswap();
+
+    LBLOG( LOG_RSP ) << "Recovered " << missing << " from parity of "
+                     << parity.writerID << std::endl;
+#ifdef CO_INSTRUMENT_RSP
+    ++nRecovered;
+#endif
+    return _handleData( sizeof( DatagramData ) + size );
 }
 
 bool RSPConnection::_handleAckRequest( const size_t bytes )
@@ -1518,6 +2150,7 @@ bool RSPConnection::_addConnection( const uint16_t id, const uint16_t sequence )
     connection->_setState( STATE_CONNECTED );
     connection->_setDescription( _getDescription( ));
     connection->_sequence = sequence;
+    connection->_parityBlock = 0; // set by first parity datagram from writer
     LBASSERT( connection->_appBuffers.isEmpty( ));
 
     // Make all buffers available for reading
@@ -1660,7 +2293,25 @@ void RSPConnection::_sendAck( const uint16_t writerID,
 #endif
 
     LBLOG( LOG_RSP ) << "send ack " << sequence << std::endl;
-    DatagramAck ack = { ACK, _id, writerID, sequence };
+    DatagramAck ack = { ACK, _id, writerID, sequence, 0, 0, 0 };
+
+    RSPConnectionPtr connection = _findConnection( writerID );
+    if( connection ) // report receive rate and loss since last ack
+    {
+        const float time = connection->_reportClock.getTimef();
+        if( connection->_reportDatagrams > 1 && time > 0.f )
+            ack.rate = uint32_t( float( connection->_reportBytes ) / time );
+
+        const uint64_t total = connection->_reportDatagrams +
+                               connection->_reportLost;
+        if( total > 0 )
+            ack.loss = uint16_t( LB_MIN( uint64_t( 1000 ),
+                                 connection->_reportLost * 1000 / total ));
+
+        connection->_reportBytes = 0;
+        connection->_reportDatagrams = 0;
+        connection->_reportLost = 0;
+    }
     ack.byteswap();
     _write->send( boost::asio::buffer( &ack, sizeof( ack )) );
 }
@@ -1699,6 +2350,12 @@ void RSPConnection::_sendAckRequest()
     LBLOG( LOG_RSP ) << "send ack request for " << uint16_t( _sequence -1 )
                      << std::endl;
     DatagramAckRequest ackRequest = { ACKREQ, _id, uint16_t( _sequence - 1 ) };
+    if( !_rttPending ) // time round trip to readers
+    {
+        _rttSequence = ackRequest.sequence;
+        _rttClock.reset();
+        _rttPending = true;
+    }
     ackRequest.byteswap();
     _write->send( boost::asio::buffer( &ackRequest, sizeof( DatagramAckRequest )) );
 }
@@ -1710,6 +2367,15 @@ std::ostream& operator << ( std::ostream& os,
        << "RSPConnection id " << connection.getID() << " send rate "
        << connection.getSendRate();
 
+    const RSPConnection::Statistics stats = connection.getStatistics();
+    os << " KB/s, sent " << stats.datagramsSent << " dgrams "
+       << stats.datagramsRepeated << " repeats " << stats.bytesSent
+       << " bytes, got " << stats.acksReceived << " acks "
+       << stats.nacksReceived << " nacks, rate " << stats.rateIncreases
+       << " up " << stats.rateDecreases << " down, slowest reader "
+       << stats.slowestRate << " KB/s loss " << stats.loss << " rtt "
+       << stats.rtt << " ms";
+
 #ifdef CO_INSTRUMENT_RSP
     const int prec = os.precision();
     os.precision( 3 );
@@ -1720,7 +2386,7 @@ std::ostream& operator << ( std::ostream& os,
        << float( nBytesRead ) / mbps << " / " << float( nBytesWritten ) / mbps
        <<  " MB/s r/w using " << nDatagrams << " dgrams " << nRepeated
        << " repeats " << nMergedDatagrams
-       << " merged"
+       << " merged " << nParity << " parity " << nRecovered << " recovered"
        << std::endl;
 
     os.precision( prec );
@@ -1737,6 +2403,8 @@ std::ostream& operator << ( std::ostream& os,
     nDatagrams = 0;
     nRepeated = 0;
     nMergedDatagrams = 0;
+    nParity = 0;
+    nRecovered = 0;
     nAckRequests = 0;
     nAcksSend = 0;
     nAcksRead = 0;
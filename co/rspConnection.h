@@ -24,11 +24,14 @@
 
 #include <co/connection.h>      // base class
 #include <co/eventConnection.h> // member
+#include <co/rspParity.h>       // member
 
-#include <lunchbox/buffer.h>  // member
-#include <lunchbox/clock.h>   // member
-#include <lunchbox/lfQueue.h> // member
-#include <lunchbox/mtQueue.h> // member
+#include <lunchbox/buffer.h>   // member
+#include <lunchbox/clock.h>    // member
+#include <lunchbox/lfQueue.h>  // member
+#include <lunchbox/lockable.h> // member
+#include <lunchbox/mtQueue.h>  // member
+#include <lunchbox/spinLock.h> // member
 
 #pragma warning(push)
 #pragma warning(disable: 4267)
@@ -74,6 +77,34 @@ public:
     /** @internal @return current send speed in kilobyte per second. */
     int64_t getSendRate() const { return _sendRate; }
 
+    /** @internal Protocol statistics of a writer. */
+    struct Statistics
+    {
+        Statistics()
+            : bytesSent( 0 ), datagramsSent( 0 ), datagramsRepeated( 0 )
+            , acksReceived( 0 ), nacksReceived( 0 ), rateIncreases( 0 )
+            , rateDecreases( 0 ), slowestRate( 0 ), loss( 0.f ), rtt( 0.f )
+        {}
+
+        uint64_t bytesSent;         //!< Datagram bytes written, incl. repeats
+        uint64_t datagramsSent;     //!< New data datagrams written
+        uint64_t datagramsRepeated; //!< Data datagrams repeated upon nacks
+        uint64_t acksReceived;      //!< Accepted acks from all readers
+        uint64_t nacksReceived;     //!< Nacks from all readers
+        uint64_t rateIncreases;     //!< Number of send rate increases
+        uint64_t rateDecreases;     //!< Number of send rate decreases
+        int64_t slowestRate; //!< Last receive rate of slowest reader in KB/s
+        float loss;          //!< Smoothed loss ratio of the slowest reader
+        float rtt;           //!< Smoothed ack round trip time in ms
+    };
+
+    /**
+     * @internal
+     * @return a consistent snapshot of the protocol statistics, which are
+     *         updated by the protocol thread.
+     */
+    CO_API Statistics getStatistics() const;
+
     /**
      * @internal
      * @return the unique identifier of this connection within the multicast
@@ -115,7 +146,8 @@ private:
         ID_DENY,   //!< deny the id, already used
         ID_CONFIRM,//!< a new node is connected
         ID_EXIT,   //!< a node is disconnected
-        COUNTNODE  //!< send to other the number of nodes which I have found
+        COUNTNODE, //!< send to other the number of nodes which I have found
+        PARITY     //!< XOR parity of a block of data packets
         // NOTE: Do not use more than 255 types here, since the endianness
         // detection magic relies on only using the LSB.
     };
@@ -197,13 +229,20 @@ private:
             }
     };
 
-    /** Acknowledge reception of all packets including sequence .*/
+    /**
+     * Acknowledge reception of all packets including sequence. Reports the
+     * receive rate and loss since the last ack for rate control. Older
+     * readers send only the fields up to sequence, which older writers read.
+     */
     struct DatagramAck
     {
         uint16_t        type;
         uint16_t        readerID;
         uint16_t        writerID;
         uint16_t        sequence;
+        uint32_t        rate; //!< receive rate in KB/s, 0 if unknown
+        uint16_t        loss; //!< permille of lost datagrams
+        uint16_t        pad;
 
         void byteswap()
             {
@@ -212,6 +251,8 @@ private:
                 lunchbox::byteswap( readerID );
                 lunchbox::byteswap( writerID );
                 lunchbox::byteswap( sequence );
+                lunchbox::byteswap( rate );
+                lunchbox::byteswap( loss );
 #endif
             }
     };
@@ -235,6 +276,28 @@ private:
             }
     };
 
+    /** Parity packet, followed by the XOR of all payloads of the block */
+    struct DatagramParity
+    {
+        uint16_t    type;
+        uint16_t    sizes;    //!< XOR of all payload sizes
+        uint16_t    writerID;
+        uint16_t    sequence; //!< first data packet of the block
+        uint16_t    count;    //!< number of data packets in the block
+        uint16_t    pad;
+
+        void byteswap()
+            {
+#ifdef COLLAGE_BIGENDIAN
+                lunchbox::byteswap( type );
+                lunchbox::byteswap( sizes );
+                lunchbox::byteswap( writerID );
+                lunchbox::byteswap( sequence );
+                lunchbox::byteswap( count );
+#endif
+            }
+    };
+
     typedef std::vector< RSPConnectionPtr > RSPConnections;
     typedef RSPConnections::iterator RSPConnectionsIter;
     typedef RSPConnections::const_iterator RSPConnectionsCIter;
@@ -259,6 +322,7 @@ private:
     boost::asio::ip::udp::socket*  _read;
     boost::asio::ip::udp::socket*  _write;
     boost::asio::ip::udp::endpoint _readAddr;
+    boost::asio::ip::udp::endpoint _writeAddr; //!< Own source, if loopback
     boost::asio::deadline_timer    _timeout;
     boost::asio::deadline_timer    _wakeup;
 
@@ -285,6 +349,38 @@ private:
 
     Buffer _recvBuffer;                      //!< Receive (thread) buffer
     std::deque< Buffer* > _recvBuffers;      //!< out-of-order buffers
+    Buffers _recvBatch;                      //!< Batched receive buffers
+
+    typedef std::vector< boost::asio::const_buffer > SendQueue;
+    SendQueue _sendQueue;   //!< Datagrams to be send in one batch
+    bool _useSegmentation;  //!< UDP segmentation offload is usable
+    bool _acksPending;      //!< Got acks, advance the write queue
+    size_t _lost;           //!< Nack'ed datagrams since last rate update
+
+    /** Datagrams per parity block, written or last received, 0 if off */
+    uint16_t _parityBlock;
+    RSPParity _parity;      //!< Parity of the current block
+    Buffer _parityBuffer;   //!< Parity datagram being send
+
+    // receiver-driven rate control, writer side
+    lunchbox::Lockable< Statistics, lunchbox::SpinLock > _statistics;
+    float _rtt;               //!< Smoothed ack round trip time
+    lunchbox::Clock _rttClock; //!< Time since ack request for _rttSequence
+    uint16_t _rttSequence;    //!< Sequence of the timed ack request
+    bool _rttPending;         //!< Waiting for an ack for _rttSequence
+    bool _reportsPending;     //!< Got new reports, adapt send rate
+    bool _rateControl;        //!< IATTR_RSP_RATE_CONTROL at listen()
+    bool _reporting;          //!< Reader sends acks with reports
+    int64_t _readerRate;      //!< Last reported receive rate of reader
+    float _readerLoss;        //!< Smoothed reported loss ratio of reader
+
+    // receiver-driven rate control, reader side
+    lunchbox::Clock _reportClock; //!< Time since first datagram of report
+    uint64_t _reportBytes;        //!< Received bytes since last ack
+    uint32_t _reportDatagrams;    //!< Received datagrams since last ack
+    uint32_t _reportLost;         //!< Lost datagrams since last ack
+    uint32_t _nDataRead;          //!< Data datagrams read, for simulated loss
+    uint32_t _testLoss;           //!< Drop every nth data datagram, or 0
 
     Buffer* _readBuffer;                     //!< Read (app) buffer
     uint64_t _readBufferPos;                 //!< Current read index
@@ -303,12 +399,30 @@ private:
     void _processOutgoing();
     void _writeData();
     void _repeatData();
+    void _countRateChange( const bool increase );
+
+    /**
+     * @return true if the only missing datagram of the parity block of the
+     *         given received sequence can be recovered from the block parity.
+     */
+    bool _isRecoverable( const uint16_t sequence ) const;
     void _finishWriteQueue( const uint16_t sequence );
 
+    void _queueSend( const void* data, const size_t size );
+    void _flushSends();
+    bool _sendSegmented( const size_t begin, const size_t end );
+
+    void _receiveBatch();
+    void _processFeedback();
+    void _adaptSendRate();
+    bool _useReports() const;
     bool _handleData( const size_t bytes );
     bool _handleAck( const size_t bytes );
     bool _handleNack();
     bool _handleAckRequest( const size_t bytes );
+    bool _handleParity( const size_t bytes );
+    bool _addParity( const DatagramData& datagram );
+    void _writeParity();
 
     Buffer* _newDataBuffer( Buffer& inBuffer );
     void _pushDataBuffer( Buffer* buffer );
@@ -0,0 +1,78 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "rspParity.h"
+
+#include <lunchbox/debug.h>
+
+namespace co
+{
+namespace
+{
+void _xor( uint8_t* to, const uint8_t* from, const uint32_t size )
+{
+    for( uint32_t i = 0; i < size; ++i )
+        to[i] ^= from[i];
+}
+}
+
+RSPParity::RSPParity( const uint32_t maxSize )
+    : _sequence( 0 )
+    , _count( 0 )
+    , _sizes( 0 )
+{
+    _data.reserve( maxSize );
+}
+
+RSPParity::~RSPParity()
+{
+}
+
+void RSPParity::reset( const uint16_t sequence )
+{
+    _data.setSize( 0 );
+    _sequence = sequence;
+    _count = 0;
+    _sizes = 0;
+}
+
+void RSPParity::add( const void* data, const uint16_t size )
+{
+    LBASSERT( size <= _data.getMaxSize( ));
+    const uint32_t length = getLength();
+    if( size > length ) // zero-pad to new payload size
+    {
+        _data.setSize( size );
+        ::memset( _data.getData() + length, 0, size - length );
+    }
+
+    _xor( _data.getData(), static_cast< const uint8_t* >( data ), size );
+    _sizes ^= size;
+    ++_count;
+}
+
+void RSPParity::apply( void* data, const uint32_t length,
+                       uint16_t& sizes ) const
+{
+    LBASSERT( length >= getLength( ));
+    _xor( static_cast< uint8_t* >( data ), getData(),
+          LB_MIN( length, getLength( )));
+    sizes ^= _sizes;
+}
+}
@@ -0,0 +1,90 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_RSPPARITY_H
+#define CO_RSPPARITY_H
+
+#include <co/api.h>
+#include <co/types.h>
+
+#include <lunchbox/buffer.h> // member
+#include <boost/noncopyable.hpp>
+
+namespace co
+{
+/** @internal
+ * The XOR parity of a block of RSP datagram payloads.
+ *
+ * The writer adds all datagrams of a block and sends the parity after the last
+ * one. A reader adds all datagrams of the block it received, and applies the
+ * result to the received parity to reconstruct a single lost datagram.
+ * Payloads of different sizes are zero-padded to the largest one.
+ */
+class RSPParity : public boost::noncopyable
+{
+public:
+    /** Construct a new parity for payloads up to maxSize bytes. */
+    CO_API explicit RSPParity( const uint32_t maxSize );
+    CO_API ~RSPParity();
+
+    /** Start a new block beginning with the given datagram sequence. */
+    CO_API void reset( const uint16_t sequence );
+
+    /** Add the payload of the next datagram of the block. */
+    CO_API void add( const void* data, const uint16_t size );
+
+    /**
+     * Apply this parity to another one.
+     *
+     * If this parity contains all but one datagram of the block, the given
+     * parity data and sizes are transformed into the payload and size of the
+     * missing datagram.
+     *
+     * @param data the payload of the other parity.
+     * @param length the payload length of the other parity, has to be at least
+     *               getLength().
+     * @param sizes the XOR'ed datagram sizes of the other parity.
+     */
+    CO_API void apply( void* data, const uint32_t length,
+                       uint16_t& sizes ) const;
+
+    /** @return the sequence of the first datagram of the block. */
+    uint16_t getSequence() const { return _sequence; }
+
+    /** @return the number of added datagrams. */
+    uint16_t getCount() const { return _count; }
+
+    /** @return the XOR of the sizes of all added datagrams. */
+    uint16_t getSizes() const { return _sizes; }
+
+    /** @return the payload size of the largest added datagram. */
+    uint32_t getLength() const { return uint32_t( _data.getSize( )); }
+
+    /** @return the parity payload. */
+    const uint8_t* getData() const { return _data.getData(); }
+
+private:
+    lunchbox::Bufferb _data;
+    uint16_t _sequence;
+    uint16_t _count;
+    uint16_t _sizes;
+};
+}
+
+#endif //CO_RSPPARITY_H
@@ -22,9 +22,114 @@
 
 #include "dataIStream.h"
 #include "dataOStream.h"
+#include "dirtyBitset.h"
+
+#include <lunchbox/atomic.h>
+#include <lunchbox/condition.h>
+#include <lunchbox/lock.h>
+#include <lunchbox/scopedMutex.h>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
 
 namespace co
 {
+namespace
+{
+typedef std::vector< boost::function< void() > > Tasks;
+
+void _runTasks( const Tasks& tasks, lunchbox::a_int32_t& next )
+{
+    for( int32_t i = ++next - 1; i < int32_t( tasks.size( )); i = ++next - 1 )
+        tasks[ i ]();
+}
+
+/**
+ * Threads shared by all parallel deserializations, one less than the number
+ * of cores since the calling thread runs tasks as well.
+ */
+class TaskPool
+{
+public:
+    TaskPool() : _tasks( 0 ), _next( 0 ), _batch( 0 ), _busy( 0 ),
+                 _stopped( false )
+    {
+        const unsigned nCores = boost::thread::hardware_concurrency();
+        for( unsigned i = 1; i < nCores; ++i )
+            _threads.create_thread( boost::bind( &TaskPool::_run, this ));
+    }
+
+    ~TaskPool()
+    {
+        _condition.lock();
+        _stopped = true;
+        _condition.broadcast();
+        _condition.unlock();
+        _threads.join_all();
+    }
+
+    /** Run all tasks using the pool and the calling thread. */
+    void run( const Tasks& tasks )
+    {
+        lunchbox::ScopedWrite mutex( _lock ); // one set of tasks at a time
+
+        _condition.lock();
+        _tasks = &tasks;
+        _next = 0;
+        ++_batch;
+        _condition.broadcast();
+        _condition.unlock();
+
+        _runTasks( tasks, _next );
+
+        _condition.lock();
+        while( _busy > 0 )
+            _condition.wait();
+        _tasks = 0;
+        _condition.unlock();
+    }
+
+private:
+    lunchbox::Lock _lock;
+    lunchbox::Condition _condition;
+    boost::thread_group _threads;
+    const Tasks* _tasks;       //!< Current tasks, 0 if none
+    lunchbox::a_int32_t _next; //!< Next task to run
+    uint64_t _batch;           //!< Incremented for each run()
+    size_t _busy;              //!< Threads working on the current tasks
+    bool _stopped;
+
+    void _run()
+    {
+        uint64_t batch = 0;
+        _condition.lock();
+        while( true )
+        {
+            while( !_stopped && batch == _batch )
+                _condition.wait();
+            if( _stopped )
+                break;
+
+            batch = _batch;
+            if( !_tasks ) // woke up after run() finished
+                continue;
+
+            const Tasks& tasks = *_tasks;
+            ++_busy;
+            _condition.unlock();
+
+            _runTasks( tasks, _next );
+
+            _condition.lock();
+            if( --_busy == 0 )
+                _condition.broadcast();
+        }
+        _condition.unlock();
+    }
+};
+}
+
 namespace detail
 {
 class Serializable
@@ -35,6 +140,22 @@ public:
 
     /** The current dirty bits. */
     uint64_t dirty;
+
+    typedef std::pair< uint64_t, co::DirtyBitset* > BitsetEntry;
+    typedef std::vector< BitsetEntry > Bitsets;
+
+    /** The element bitsets per dirty bit. */
+    Bitsets bitsets;
+
+    void clearBitsets( const uint64_t bits )
+    {
+        for( Bitsets::const_iterator i = bitsets.begin();
+             i != bitsets.end(); ++i )
+        {
+            if( i->first & bits )
+                i->second->clear();
+        }
+    }
 };
 }
 
@@ -70,6 +191,7 @@ bool Serializable::isDirty( const uint64_t dirtyBits ) const
 uint128_t Serializable::commit( const uint32_t incarnation )
 {
     const uint128_t& version = co::Object::commit( incarnation );
+    _impl->clearBitsets( _impl->dirty );
     _impl->dirty = DIRTY_NONE;
     return version;
 }
@@ -82,6 +204,39 @@ void Serializable::setDirty( const uint64_t bits )
 void Serializable::unsetDirty( const uint64_t bits )
 {
     _impl->dirty &= ~bits;
+    _impl->clearBitsets( bits );
+}
+
+void Serializable::setDirtyBitset( const uint64_t bit, DirtyBitset* bitset )
+{
+    detail::Serializable::Bitsets& bitsets = _impl->bitsets;
+    for( detail::Serializable::Bitsets::iterator i = bitsets.begin();
+         i != bitsets.end(); ++i )
+    {
+        if( i->first != bit )
+            continue;
+
+        if( bitset )
+            i->second = bitset;
+        else
+            bitsets.erase( i );
+        return;
+    }
+
+    if( bitset )
+        bitsets.push_back( detail::Serializable::BitsetEntry( bit, bitset ));
+}
+
+void Serializable::setDirtyRange( const uint64_t bit, const size_t first,
+                                  const size_t last )
+{
+    for( detail::Serializable::Bitsets::const_iterator i =
+             _impl->bitsets.begin(); i != _impl->bitsets.end(); ++i )
+    {
+        if( i->first == bit )
+            i->second->set( first, last );
+    }
+    setDirty( bit );
 }
 
 void Serializable::notifyAttached()
@@ -117,4 +272,78 @@ void Serializable::unpack( co::DataIStream& is )
     deserialize( is, dirty );
 }
 
+void Serializable::unpackSlaveCommits( const DataIStreams& commits )
+{
+    if( !mergeSlaveCommits( ))
+    {
+        co::Object::unpackSlaveCommits( commits );
+        return;
+    }
+
+    const size_t size = commits.size();
+    std::vector< uint64_t > dirty( size, DIRTY_NONE );
+    for( size_t i = 0; i < size; ++i )
+        if( commits[i]->hasData( ))
+            *commits[i] >> dirty[i];
+
+    // Element ranges of bits with a bitset differ between commits, so later
+    // commits do not overwrite them.
+    uint64_t ranged = DIRTY_NONE;
+    for( detail::Serializable::Bitsets::const_iterator i =
+             _impl->bitsets.begin(); i != _impl->bitsets.end(); ++i )
+    {
+        ranged |= i->first;
+    }
+
+    // latest wins: drop commits fully overwritten by later ones
+    uint64_t later = DIRTY_NONE;
+    for( size_t i = size; i > 0; --i )
+    {
+        const uint64_t bits = dirty[ i - 1 ];
+        if( ( bits & ~( later & ~ranged )) == 0 )
+            dirty[ i - 1 ] = DIRTY_NONE;
+        later |= bits;
+    }
+
+    // dirty bits set by more than one remaining commit
+    uint64_t once = DIRTY_NONE;
+    uint64_t shared = DIRTY_NONE;
+    for( size_t i = 0; i < size; ++i )
+    {
+        shared |= once & dirty[i];
+        once |= dirty[i];
+    }
+
+    // commits with shared bits in order, the others commute with them
+    const bool parallel = isDeserializeParallel();
+    std::vector< size_t > independent;
+    for( size_t i = 0; i < size; ++i )
+    {
+        if( dirty[i] == DIRTY_NONE )
+            continue;
+        if( parallel && ( dirty[i] & shared ) == 0 )
+            independent.push_back( i );
+        else
+            deserialize( *commits[i], dirty[i] );
+    }
+    if( independent.size() < 2 )
+    {
+        if( !independent.empty( ))
+            deserialize( *commits[ independent.front() ],
+                         dirty[ independent.front() ] );
+        return;
+    }
+
+    Tasks tasks;
+    for( size_t i = 0; i < independent.size(); ++i )
+    {
+        const size_t j = independent[i];
+        tasks.push_back( boost::bind( &Serializable::deserialize, this,
+                                      boost::ref( *commits[j] ), dirty[j] ));
+    }
+
+    static TaskPool pool;
+    pool.run( tasks );
+}
+
 }
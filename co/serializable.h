@@ -112,6 +112,60 @@ protected:
     /** Remove dirty flags to clear data from distribution. @version 1.0 */
     CO_API virtual void unsetDirty( const uint64_t bits );
 
+    /**
+     * Track modified array elements for the given dirty bit.
+     *
+     * The bitset is cleared together with the dirty bit after each commit
+     * and in unsetDirty(). The bitset has to stay valid until it is removed
+     * by passing 0, or until the serializable is destroyed.
+     *
+     * @param bit the dirty bit covering the array.
+     * @param bitset the element bitset, or 0 to remove the current one.
+     * @sa DirtyBitset
+     * @version 1.1.1
+     */
+    CO_API void setDirtyBitset( const uint64_t bit, DirtyBitset* bitset );
+
+    /**
+     * Mark the array elements [first, last) of the given dirty bit modified.
+     *
+     * Sets the dirty bit and the elements in the bitset set using
+     * setDirtyBitset(). Without a bitset only the dirty bit is set.
+     * @version 1.1.1
+     */
+    CO_API void setDirtyRange( const uint64_t bit, const size_t first,
+                               const size_t last );
+
+    /**
+     * Merge queued slave commits before applying them on the master.
+     *
+     * If this method returns true, sync( VERSION_HEAD ) on the master
+     * instance drops all slave commits whose dirty bits are all set by later
+     * slave commits, that is, the latest slave commit wins for each dirty
+     * bit. This requires that deserialize() overwrites and does not
+     * accumulate the data of each dirty bit. Commits with a dirty bit which
+     * has a DirtyBitset set using setDirtyBitset() are never dropped, since
+     * they carry different element ranges.
+     *
+     * @return true to merge slave commits, false to apply all of them.
+     * @version 1.1.1
+     */
+    virtual bool mergeSlaveCommits() const { return false; }
+
+    /**
+     * Allow concurrent deserialization of independent slave commits.
+     *
+     * If this method and mergeSlaveCommits() return true, the remaining slave
+     * commits sharing no dirty bits with any other one are deserialized in
+     * parallel by a thread pool shared by all objects, using at most one
+     * thread per core. The object has to guarantee that concurrent
+     * deserialize() calls with disjoint dirty bits are safe.
+     *
+     * @return true if deserialize() of disjoint dirty bits is thread-safe.
+     * @version 1.1.1
+     */
+    virtual bool isDeserializeParallel() const { return false; }
+
     /** @sa Object::getChangeType() */
     ChangeType getChangeType() const override { return DELTA; }
 
@@ -125,6 +179,7 @@ protected:
 
     CO_API void pack( co::DataOStream& os ) final;
     CO_API void unpack( co::DataIStream& is ) final;
+    CO_API void unpackSlaveCommits( const DataIStreams& commits ) override;
 
 private:
     detail::Serializable* const _impl;
@@ -0,0 +1,587 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "stripedConnection.h"
+
+#include "connectionDescription.h"
+#include "global.h"
+
+#include <lunchbox/log.h>
+
+#include <algorithm>
+#include <poll.h>
+#include <string.h>
+#ifdef __linux__
+#  include <sys/epoll.h>
+#  include <unistd.h>
+#endif
+
+namespace co
+{
+namespace
+{
+/** Sends up to this size are copied with their header into one write. */
+static const uint64_t _copySize = 4096;
+
+#ifdef __linux__
+/** The notifier signals the hello, do not wait for it. */
+static const int _helloTimeout = 0;
+#else
+/** Time in ms to wait for the handshake of a newly accepted socket. */
+static const int _helloTimeout = 100;
+#endif
+}
+
+StripedConnection::StripedConnection()
+        : _notifier( -1 )
+        , _sendSequence( 0 )
+        , _stripeUnit( 0 )
+        , _recvSequence( 0 )
+        , _frameLeft( 0 )
+        , _aheadPos( 0 )
+{
+    ConnectionDescriptionPtr description = _getDescription();
+    description->type = CONNECTIONTYPE_TCPIP_STRIPED;
+    description->bandwidth = 409600; // 400MB
+
+    LBVERB << "New StripedConnection @" << (void*)this << std::endl;
+}
+
+StripedConnection::~StripedConnection()
+{
+    _close();
+}
+
+Connection::Notifier StripedConnection::getNotifier() const
+{
+    if( _listener )
+        return _notifier;
+    if( _stripes.empty( ))
+        return 0;
+    return _stripes.front()->getNotifier();
+}
+
+ConnectionPtr StripedConnection::_createStripe() const
+{
+    ConnectionDescriptionPtr description =
+        new ConnectionDescription( *getDescription( ));
+    description->type = CONNECTIONTYPE_TCPIP;
+    return Connection::create( description );
+}
+
+//----------------------------------------------------------------------
+// connect
+//----------------------------------------------------------------------
+bool StripedConnection::connect()
+{
+    LBASSERT( getDescription()->type == CONNECTIONTYPE_TCPIP_STRIPED );
+    if( !isClosed( ))
+        return false;
+
+    _setState( STATE_CONNECTING );
+
+    const uint32_t nStripes =
+        std::max( 1, Global::getIAttribute( Global::IATTR_TCP_STRIPES ));
+    const UUID id( true );
+
+    for( uint32_t i = 0; i < nStripes; ++i )
+    {
+        ConnectionPtr stripe = _createStripe();
+        if( !stripe || !stripe->connect( ))
+        {
+            if( stripe )
+                stripe->close();
+            close();
+            return false;
+        }
+
+        _stripes.push_back( stripe );
+        const Hello hello = { id.high(), id.low(), i, nStripes };
+        if( !stripe->send( &hello, sizeof( hello )))
+        {
+            close();
+            return false;
+        }
+    }
+
+    _stripeUnit = std::max( 1, Global::getIAttribute(
+                                   Global::IATTR_TCP_STRIPE_UNIT ));
+    _setState( STATE_CONNECTED );
+    LBINFO << "Connected " << nStripes << " stripes to "
+           << getDescription()->toString() << std::endl;
+    return true;
+}
+
+bool StripedConnection::listen()
+{
+    ConnectionDescriptionPtr description = _getDescription();
+    LBASSERT( description->type == CONNECTIONTYPE_TCPIP_STRIPED );
+    if( !isClosed( ))
+        return false;
+
+    _setState( STATE_CONNECTING );
+    _listener = _createStripe();
+    if( !_listener || !_listener->listen( ))
+    {
+        close();
+        return false;
+    }
+
+    // propagate the port and host name chosen by the socket
+    ConstConnectionDescriptionPtr socketDescription =
+        _listener->getDescription();
+    description->port = socketDescription->port;
+    description->setHostname( socketDescription->getHostname( ));
+
+#ifdef __linux__
+    // poll the listener and the sockets waiting for their hello together
+    _notifier = ::epoll_create( 1 );
+    if( _notifier < 0 )
+    {
+        LBERROR << "epoll_create : " << lunchbox::sysError << std::endl;
+        close();
+        return false;
+    }
+    if( !_watch( _listener ))
+    {
+        close();
+        return false;
+    }
+#else
+    _notifier = _listener->getNotifier();
+#endif
+
+    _setState( STATE_LISTENING );
+    return true;
+}
+
+void StripedConnection::acceptNB()
+{
+    LBASSERT( isListening( ));
+    _listener->acceptNB();
+}
+
+ConnectionPtr StripedConnection::acceptSync()
+{
+    if( !isListening( ))
+        return 0;
+
+    _expire();
+
+    // Accept one socket per call. Stripes of incomplete connections are kept
+    // pending, and the connection is returned once its last stripe arrived.
+    // The notifier also fires for handshakes, only accept if the listener
+    // has a connection request.
+    ConnectionPtr stripe;
+    if( _hasData( _listener, 0 ))
+        stripe = _listener->acceptSync();
+    if( stripe )
+    {
+        const Handshake handshake = { stripe, _clock.getTime64() };
+        _handshakes.push_back( handshake );
+        if( !_watch( stripe ))
+        {
+            _handshakes.pop_back();
+            stripe->close();
+            stripe = 0;
+        }
+    }
+
+    for( Handshakes::iterator i = _handshakes.begin();
+         i != _handshakes.end(); )
+    {
+        // the hello is send right after connecting, wait only briefly for it
+        // on the new socket and not at all on older ones
+        if( !_hasData( i->stripe, i->stripe == stripe ? _helloTimeout : 0 ))
+        {
+            ++i;
+            continue;
+        }
+
+        ConnectionPtr handshake = i->stripe;
+        i = _handshakes.erase( i );
+        _unwatch( handshake );
+
+        ConnectionPtr connection = _addStripe( handshake );
+        if( connection )
+            return connection;
+    }
+    return 0;
+}
+
+void StripedConnection::_expire()
+{
+    const int64_t timeout = Global::getKeepaliveTimeout();
+    const int64_t now = _clock.getTime64();
+
+    for( Handshakes::iterator i = _handshakes.begin();
+         i != _handshakes.end(); )
+    {
+        if( now - i->time < timeout )
+        {
+            ++i;
+            continue;
+        }
+
+        LBWARN << "Stripe handshake from "
+               << i->stripe->getDescription()->toString() << " timed out"
+               << std::endl;
+        _unwatch( i->stripe );
+        i->stripe->close();
+        i = _handshakes.erase( i );
+    }
+
+    for( PendingHash::iterator i = _pending.begin(); i != _pending.end(); )
+    {
+        if( now - i->second.time < timeout )
+        {
+            ++i;
+            continue;
+        }
+
+        LBWARN << "Incomplete striped connection timed out" << std::endl;
+        const Connections& stripes = i->second.stripes;
+        for( ConnectionsCIter j = stripes.begin(); j != stripes.end(); ++j )
+            if( *j )
+                (*j)->close();
+        _pending.erase( i++ );
+    }
+}
+
+bool StripedConnection::_watch( ConnectionPtr stripe LB_UNUSED )
+{
+#ifdef __linux__
+    struct epoll_event evctl;
+    ::memset( (void *)&evctl, 0, sizeof( evctl ));
+    evctl.events = EPOLLIN;
+    evctl.data.fd = stripe->getNotifier();
+    if( ::epoll_ctl( _notifier, EPOLL_CTL_ADD, evctl.data.fd, &evctl ))
+    {
+        LBERROR << "epoll_ctl : " << lunchbox::sysError << std::endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void StripedConnection::_unwatch( ConnectionPtr stripe LB_UNUSED )
+{
+#ifdef __linux__
+    struct epoll_event evctl; // non-null for kernels before 2.6.9
+    if( ::epoll_ctl( _notifier, EPOLL_CTL_DEL, stripe->getNotifier(), &evctl ))
+        LBWARN << "epoll_ctl : " << lunchbox::sysError << std::endl;
+#endif
+}
+
+ConnectionPtr StripedConnection::_addStripe( ConnectionPtr stripe )
+{
+    Hello hello;
+    if( !_read( stripe, &hello, sizeof( hello )) || hello.nStripes == 0 ||
+        hello.index >= hello.nStripes )
+    {
+        LBWARN << "Invalid stripe handshake from "
+               << stripe->getDescription()->toString() << std::endl;
+        stripe->close();
+        return 0;
+    }
+
+    const uint128_t id( hello.high, hello.low );
+    Pending& pending = _pending[ id ];
+    Connections& stripes = pending.stripes;
+    if( stripes.empty( ))
+    {
+        stripes.resize( hello.nStripes );
+        pending.time = _clock.getTime64();
+    }
+    if( stripes.size() != hello.nStripes || stripes[ hello.index ] )
+    {
+        LBWARN << "Inconsistent stripe handshake from "
+               << stripe->getDescription()->toString() << std::endl;
+        stripe->close();
+        return 0;
+    }
+
+    stripes[ hello.index ] = stripe;
+    if( std::find( stripes.begin(), stripes.end(), ConnectionPtr( )) !=
+        stripes.end( ))
+    {
+        return 0; // wait for the remaining stripes
+    }
+
+    StripedConnection* connection = new StripedConnection;
+    ConnectionDescriptionPtr description =
+        new ConnectionDescription( *stripes.front()->getDescription( ));
+    description->type = CONNECTIONTYPE_TCPIP_STRIPED;
+    description->bandwidth = getDescription()->bandwidth;
+
+    connection->_setDescription( description );
+    connection->_stripes.swap( stripes );
+    connection->_stripeUnit = std::max( 1, Global::getIAttribute(
+                                            Global::IATTR_TCP_STRIPE_UNIT ));
+    connection->_setState( STATE_CONNECTED );
+    _pending.erase( id );
+
+    LBINFO << "Accepted " << hello.nStripes << " stripes from "
+           << description->toString() << std::endl;
+    return connection;
+}
+
+bool StripedConnection::_hasData( ConnectionPtr stripe, const int timeout )
+{
+    pollfd fd = { stripe->getNotifier(), POLLIN, 0 };
+    return ::poll( &fd, 1, timeout ) > 0;
+}
+
+void StripedConnection::_close()
+{
+    if( isClosed( ))
+        return;
+
+    _setState( STATE_CLOSING );
+    if( _listener )
+        _listener->close();
+    _listener = 0;
+
+    for( ConnectionsCIter i = _stripes.begin(); i != _stripes.end(); ++i )
+        (*i)->close();
+    _stripes.clear();
+
+    for( PendingHash::const_iterator i = _pending.begin();
+         i != _pending.end(); ++i )
+    {
+        const Connections& stripes = i->second.stripes;
+        for( ConnectionsCIter j = stripes.begin(); j != stripes.end(); ++j )
+            if( *j )
+                (*j)->close();
+    }
+    _pending.clear();
+
+    for( Handshakes::const_iterator i = _handshakes.begin();
+         i != _handshakes.end(); ++i )
+    {
+        i->stripe->close();
+    }
+    _handshakes.clear();
+
+#ifdef __linux__
+    if( _notifier >= 0 )
+        ::close( _notifier );
+#endif
+    _notifier = -1;
+
+    _ahead.clear();
+    _aheadPos = 0;
+    _frameLeft = 0;
+    _setState( STATE_CLOSED );
+}
+
+size_t StripedConnection::_getStripe( const uint64_t unit,
+                                      const uint64_t nUnits ) const
+{
+    // the last unit goes to the head stripe, which signals the frame's data
+    if( unit + 1 == nUnits )
+        return 0;
+    return ( unit + 1 ) % _stripes.size();
+}
+
+//----------------------------------------------------------------------
+// write
+//----------------------------------------------------------------------
+int64_t StripedConnection::write( const void* buffer, const uint64_t bytes )
+{
+    if( !isConnected( ))
+        return -1;
+
+    const uint8_t* ptr = static_cast< const uint8_t* >( buffer );
+    Header header = { _sendSequence++, bytes, 0, 0 };
+    ConnectionPtr head = _stripes.front();
+
+    if( bytes <= _stripeUnit || _stripes.size() == 1 )
+    {
+        if( bytes <= _copySize )
+        {
+            _sendBuffer.replace( &header, sizeof( header ));
+            _sendBuffer.append( ptr, bytes );
+            if( !head->send( _sendBuffer.getData(), _sendBuffer.getSize( )))
+                return -1;
+        }
+        else if( !head->send( &header, sizeof( header )) ||
+                 !head->send( ptr, bytes ))
+        {
+            return -1;
+        }
+        return bytes;
+    }
+
+    header.unit = uint32_t( _stripeUnit );
+    if( !head->send( &header, sizeof( header )))
+        return -1;
+
+    const uint64_t nUnits = ( bytes + _stripeUnit - 1 ) / _stripeUnit;
+    for( uint64_t i = 0; i < nUnits; ++i )
+        if( !_sendUnit( header, i, nUnits, ptr + i * _stripeUnit ))
+            return -1;
+    return bytes;
+}
+
+bool StripedConnection::_sendUnit( const Header& frame, const uint64_t unit,
+                                   const uint64_t nUnits, const uint8_t* ptr )
+{
+    ConnectionPtr stripe = _stripes[ _getStripe( unit, nUnits ) ];
+
+    // the first unit on each secondary stripe repeats the frame header
+    if( unit + 1 < _stripes.size() && unit + 1 < nUnits &&
+        !stripe->send( &frame, sizeof( frame )))
+    {
+        return false;
+    }
+
+    const uint64_t size = std::min( uint64_t( frame.unit ),
+                                    frame.size - unit * frame.unit );
+    return stripe->send( ptr, size );
+}
+
+//----------------------------------------------------------------------
+// read
+//----------------------------------------------------------------------
+int64_t StripedConnection::readSync( void* buffer, const uint64_t bytes,
+                                     const bool )
+{
+    if( !isConnected( ))
+        return -1;
+
+    uint8_t* ptr = static_cast< uint8_t* >( buffer );
+    if( _frameLeft == 0 )
+    {
+        Header header;
+        if( !_read( _stripes.front(), &header, sizeof( header )))
+            return _readError();
+
+        if( header.sequence != _recvSequence )
+        {
+            LBERROR << "Out-of-sync striped stream: got frame "
+                    << header.sequence << ", expected " << _recvSequence
+                    << std::endl;
+            return _readError();
+        }
+        ++_recvSequence;
+        _frameLeft = header.size;
+
+        if( header.unit > 0 )
+        {
+            const uint64_t nUnits = ( header.size + header.unit - 1 ) /
+                                    header.unit;
+            // Read the whole frame directly if requested, which is the case
+            // for large command payloads. Otherwise read all but the last unit
+            // ahead, which is left on the head stripe to signal the remainder.
+            const bool direct = bytes >= header.size;
+            uint8_t* data = ptr;
+            if( !direct )
+            {
+                _ahead.resize( ( nUnits - 1 ) * header.unit );
+                _aheadPos = 0;
+                data = _ahead.getData();
+            }
+
+            const uint64_t nRead = direct ? nUnits : nUnits - 1;
+            for( uint64_t i = 0; i < nRead; ++i )
+                if( !_readUnit( header, i, nUnits, data + i * header.unit ))
+                    return _readError();
+
+            if( direct )
+            {
+                _frameLeft = 0;
+                return header.size;
+            }
+        }
+    }
+
+    if( _aheadPos < _ahead.getSize( ))
+    {
+        const uint64_t size = std::min( bytes, _ahead.getSize() - _aheadPos );
+        ::memcpy( ptr, _ahead.getData() + _aheadPos, size );
+        _aheadPos += size;
+        _frameLeft -= size;
+        if( _aheadPos == _ahead.getSize( ))
+        {
+            _ahead.setSize( 0 );
+            _aheadPos = 0;
+        }
+        return size;
+    }
+
+    ConnectionPtr head = _stripes.front();
+    const uint64_t size = std::min( bytes, _frameLeft );
+    head->readNB( ptr, size );
+    const int64_t got = head->readSync( ptr, size, true );
+    if( got < 0 )
+        return _readError();
+
+    _frameLeft -= got;
+    return got;
+}
+
+bool StripedConnection::_readUnit( const Header& frame, const uint64_t unit,
+                                   const uint64_t nUnits, uint8_t* ptr )
+{
+    ConnectionPtr stripe = _stripes[ _getStripe( unit, nUnits ) ];
+    if( unit + 1 < _stripes.size() && unit + 1 < nUnits )
+    {
+        Header header;
+        if( !_read( stripe, &header, sizeof( header )))
+            return false;
+        if( header.sequence != frame.sequence || header.size != frame.size )
+        {
+            LBERROR << "Out-of-sync stripe " << _getStripe( unit, nUnits )
+                    << ": got frame " << header.sequence << ", expected "
+                    << frame.sequence << std::endl;
+            return false;
+        }
+    }
+
+    const uint64_t size = std::min( uint64_t( frame.unit ),
+                                    frame.size - unit * frame.unit );
+    return _read( stripe, ptr, size );
+}
+
+bool StripedConnection::_read( ConnectionPtr stripe, void* buffer,
+                               const uint64_t bytes )
+{
+    uint8_t* ptr = static_cast< uint8_t* >( buffer );
+    uint64_t bytesLeft = bytes;
+    while( bytesLeft )
+    {
+        stripe->readNB( ptr, bytesLeft );
+        const int64_t got = stripe->readSync( ptr, bytesLeft, true );
+        if( got < 0 )
+            return false;
+
+        ptr += got;
+        bytesLeft -= got;
+    }
+    return true;
+}
+
+int64_t StripedConnection::_readError()
+{
+    close();
+    return -1;
+}
+
+}
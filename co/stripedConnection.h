@@ -0,0 +1,144 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This file is part of Collage <https://github.com/Eyescale/Collage>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_STRIPEDCONNECTION_H
+#define CO_STRIPEDCONNECTION_H
+
+#include <co/connection.h> // base class
+#include <co/types.h>
+
+#include <lunchbox/buffer.h> // member
+#include <lunchbox/clock.h>  // member
+#include <lunchbox/stdExt.h> // member
+
+namespace co
+{
+#ifdef _WIN32
+#  error StripedConnection not used nor supported on Windows
+#endif
+
+    /**
+     * A connection striping large sends over multiple TCP/IP sockets.
+     *
+     * The initiating side opens Global::IATTR_TCP_STRIPES sockets to the
+     * listener, which groups them into one connection. The listener accepts
+     * one socket per acceptSync() and returns the connection once its last
+     * stripe has arrived, so a slow peer does not block the receiver thread.
+     * On Linux, the notifier of a listening connection also signals sockets
+     * with a pending handshake. Handshakes and incomplete connections are
+     * dropped after Global::getKeepaliveTimeout().
+     *
+     * Each send is framed by a header carrying a sequence number on the first
+     * socket. Sends larger than Global::IATTR_TCP_STRIPE_UNIT are split into
+     * units, which are distributed round-robin over all sockets. The last unit
+     * of a frame is always sent on the first socket, which provides the
+     * notifier for the connection.
+     */
+    class StripedConnection : public Connection
+    {
+    public:
+        StripedConnection();
+
+        bool connect() override;
+        bool listen() override;
+        void acceptNB() override;
+        ConnectionPtr acceptSync() override;
+        void close() override { _close(); }
+
+        Notifier getNotifier() const override;
+
+    protected:
+        virtual ~StripedConnection();
+
+        void readNB( void*, const uint64_t ) override { /* NOP */ }
+        int64_t readSync( void* buffer, const uint64_t bytes,
+                          const bool ignored ) override;
+        int64_t write( const void* buffer, const uint64_t bytes ) override;
+
+    private:
+        /** Frame header, also used to verify the units on other sockets. */
+        struct Header
+        {
+            uint64_t sequence; //!< Frame number
+            uint64_t size;     //!< Frame payload size
+            uint32_t unit;     //!< Stripe unit size, 0 if not striped
+            uint32_t pad;
+        };
+
+        /** Handshake send on each socket by the connecting side. */
+        struct Hello
+        {
+            uint64_t high;     //!< Connection identifier
+            uint64_t low;
+            uint32_t index;    //!< Index of this socket
+            uint32_t nStripes; //!< Total number of sockets
+        };
+
+        /** Accepted socket without a hello yet. */
+        struct Handshake
+        {
+            ConnectionPtr stripe;
+            int64_t time;      //!< Accept time
+        };
+
+        /** Incomplete incoming connection. */
+        struct Pending
+        {
+            Connections stripes;
+            int64_t time;      //!< Arrival time of the first stripe
+        };
+
+        typedef std::vector< Handshake > Handshakes;
+        typedef stde::hash_map< uint128_t, Pending > PendingHash;
+
+        ConnectionPtr _listener; //!< Listening socket
+        Notifier _notifier;      //!< Listener and handshake events
+        lunchbox::Clock _clock;  //!< Handshake and pending timeouts
+        PendingHash _pending;    //!< Incomplete incoming connections
+        Handshakes _handshakes;  //!< Accepted sockets without a hello yet
+        Connections _stripes;    //!< Connected sockets, first one is the head
+
+        uint64_t _sendSequence;  //!< Next frame number to send
+        uint64_t _stripeUnit;    //!< Send units of this size
+        lunchbox::Bufferb _sendBuffer; //!< Header and data of small sends
+
+        uint64_t _recvSequence;  //!< Next frame number to receive
+        uint64_t _frameLeft;     //!< Unread bytes of the current frame
+        lunchbox::Bufferb _ahead; //!< Units read ahead for partial reads
+        uint64_t _aheadPos;      //!< Read position in _ahead
+
+        ConnectionPtr _createStripe() const;
+        ConnectionPtr _addStripe( ConnectionPtr stripe );
+        void _expire();
+        bool _watch( ConnectionPtr stripe );
+        void _unwatch( ConnectionPtr stripe );
+        static bool _hasData( ConnectionPtr stripe, const int timeout );
+        size_t _getStripe( const uint64_t unit, const uint64_t nUnits ) const;
+        bool _sendUnit( const Header& frame, const uint64_t unit,
+                        const uint64_t nUnits, const uint8_t* ptr );
+        bool _readUnit( const Header& frame, const uint64_t unit,
+                        const uint64_t nUnits, uint8_t* ptr );
+        static bool _read( ConnectionPtr stripe, void* buffer,
+                           const uint64_t bytes );
+        int64_t _readError();
+        void _close();
+    };
+}
+
+#endif //CO_STRIPEDCONNECTION_H
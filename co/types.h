@@ -41,12 +41,14 @@ namespace co
 class Barrier;
 class Buffer;
 class CommandQueue;
+class CompletionGroup;
 class Connection;
 class ConnectionDescription;
 class ConnectionListener;
 class CustomICommand;
 class CustomOCommand;
 class DataIStream;
+class DirtyBitset;
 class DataOStream;
 class Global;
 class ICommand;
@@ -152,6 +154,7 @@ typedef std::vector< ObjectVersion > ObjectVersions;
 typedef ObjectVersions::const_iterator ObjectVersionsCIter;
 typedef std::deque< ObjectDataIStream* > ObjectDataIStreamDeque;
 typedef std::vector< ObjectDataIStream* > ObjectDataIStreams;
+typedef std::vector< DataIStream* > DataIStreams;
 /** @endcond */
 
 }
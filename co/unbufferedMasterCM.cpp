@@ -50,13 +50,23 @@ uint128_t UnbufferedMasterCM::commit( const uint32_t )
     if( !_object->isDirty( ))
         return _version;
 
-    _maxVersion.waitGE( _version.low() + 1 );
+    _waitCommitWindow();
     Mutex mutex( _slaves );
     if( _slaves->empty( ))
         return _version;
 
+    _updateReceivers();
+    if( _receivers.empty( ))
+    {
+        // all slaves lag, they get the new version with the catch-up
+        ++_version;
+        LBASSERT( _version != VERSION_NONE );
+        _sendCatchUp();
+        return _version;
+    }
+
     ObjectDeltaDataOStream os( this );
-    os.enableCommit( _version + 1, *_slaves );
+    os.enableCommit( _version + 1, _receivers );
     _object->pack( os );
     os.disable();
 
@@ -68,6 +78,7 @@ uint128_t UnbufferedMasterCM::commit( const uint32_t )
         LBLOG( LOG_OBJECTS ) << "Committed v" << _version << ", id "
                              << _object->getID() << std::endl;
 #endif
+        _sendCatchUp();
     }
 
     return _version;
@@ -20,10 +20,14 @@
 
 #include "versionedMasterCM.h"
 
+#include "localNode.h"
 #include "log.h"
 #include "object.h"
 #include "objectDataICommand.h"
 #include "objectDataIStream.h"
+#include "objectICommand.h"
+#include "objectInstanceDataOStream.h"
+#include "objectOCommand.h"
 
 namespace co
 {
@@ -51,6 +55,10 @@ VersionedMasterCM::VersionedMasterCM( Object* object )
     object->registerCommand( CMD_OBJECT_MAX_VERSION,
                             CmdFunc( this, &VersionedMasterCM::_cmdMaxVersion ),
                              0 );
+    // serializes the instance data, like mapping
+    object->registerCommand( CMD_OBJECT_CATCH_UP,
+                             CmdFunc( this, &VersionedMasterCM::_cmdCatchUp ),
+                             object->getLocalNode()->getCommandThreadQueue( ));
 }
 
 VersionedMasterCM::~VersionedMasterCM()
@@ -73,13 +81,22 @@ uint128_t VersionedMasterCM::sync( const uint128_t& inVersion )
 
     if( inVersion == VERSION_HEAD )
     {
-        uint128_t version = VERSION_NONE;
+        ObjectDataIStreams commits;
         for( ObjectDataIStream* is = _slaveCommits.tryPop(); is;
              is = _slaveCommits.tryPop( ))
         {
-            version = _apply( is );
+            commits.push_back( is );
+        }
+
+        switch( commits.size( ))
+        {
+          case 0:
+            return VERSION_NONE;
+          case 1:
+            return _apply( commits.front( ));
+          default:
+            return _apply( commits );
         }
-        return version;
     }
     // else apply only concrete slave commit
 
@@ -101,6 +118,22 @@ uint128_t VersionedMasterCM::_apply( ObjectDataIStream* is )
     return version;
 }
 
+uint128_t VersionedMasterCM::_apply( const ObjectDataIStreams& commits )
+{
+    DataIStreams streams( commits.begin(), commits.end( ));
+    _object->unpackSlaveCommits( streams );
+
+    const uint128_t version = commits.back()->getVersion();
+    for( ObjectDataIStreams::const_iterator i = commits.begin();
+         i != commits.end(); ++i )
+    {
+        LBASSERT( !(*i)->hasInstanceData( ));
+        (*i)->reset();
+        _slaveCommits.recycle( *i );
+    }
+    return version;
+}
+
 bool VersionedMasterCM::addSlave( const MasterCMCommand& command )
 {
     LB_TS_THREAD( _cmdThread );
@@ -116,7 +149,10 @@ bool VersionedMasterCM::addSlave( const MasterCMCommand& command )
     if( data.maxVersion == 0 )
         data.maxVersion = std::numeric_limits< uint64_t >::max();
     else if( data.maxVersion < std::numeric_limits< uint64_t >::max( ))
+    {
+        data.maxVersions = data.maxVersion;
         data.maxVersion += _version.low();
+    }
 
     _slaveData.push_back( data );
     _updateMaxVersion();
@@ -171,6 +207,138 @@ void VersionedMasterCM::removeSlaves( NodePtr node )
     _updateMaxVersion();
 }
 
+bool VersionedMasterCM::isCommitBlocked() const
+{
+    if( _object->coalesceSlaveVersions( ))
+        return false;
+
+    Mutex mutex( _slaves );
+    return _maxVersion.get() < _version.low() + 1;
+}
+
+void VersionedMasterCM::_waitCommitWindow()
+{
+    if( !_object->coalesceSlaveVersions( ))
+        _maxVersion.waitGE( _version.low() + 1 );
+}
+
+void VersionedMasterCM::_updateReceivers()
+{
+    if( !_object->coalesceSlaveVersions( ))
+    {
+        _receivers = *_slaves;
+        return;
+    }
+
+    // Nodes with a slave instance at its max versions or already lagging.
+    // All instances on these nodes are excluded, since commit data is sent
+    // to all instances of a node.
+    const uint64_t next = _version.low() + 1;
+    Nodes lagging;
+    for( SlaveDatasCIter i = _slaveData.begin(); i != _slaveData.end(); ++i )
+        if( i->lagging || i->maxVersion < next )
+            lagging.push_back( i->node );
+    lunchbox::usort( lagging );
+
+    // Nodes with instances which did not yet apply all versions send to them
+    Nodes waiting;
+    for( SlaveDatasIter i = _slaveData.begin(); i != _slaveData.end(); ++i )
+    {
+        if( !std::binary_search( lagging.begin(), lagging.end(), i->node ))
+            continue;
+
+        if( !i->lagging )
+        {
+            i->lagging = true;
+            i->lastVersion = _version.low();
+        }
+        if( i->maxVersions > 0 &&
+            i->maxVersion - i->maxVersions < i->lastVersion )
+        {
+            waiting.push_back( i->node );
+        }
+    }
+    lunchbox::usort( waiting );
+
+    for( SlaveDatasIter i = _slaveData.begin(); i != _slaveData.end(); ++i )
+        i->catchUp = i->lagging &&
+                   !std::binary_search( waiting.begin(), waiting.end(), i->node );
+
+    _receivers.clear();
+    for( NodesCIter i = _slaves->begin(); i != _slaves->end(); ++i )
+        if( !std::binary_search( lagging.begin(), lagging.end(), *i ))
+            _receivers.push_back( *i );
+}
+
+void VersionedMasterCM::_sendCatchUp()
+{
+    ObjectInstanceDataOStream os( this );
+    bool first = true;
+    for( SlaveDatasIter i = _slaveData.begin(); i != _slaveData.end(); ++i )
+    {
+        if( !i->catchUp )
+            continue;
+
+        if( i->lastVersion >= _version.low( )) // nothing missed
+        {
+            i->lagging = false;
+            i->catchUp = false;
+            continue;
+        }
+
+        _sendHead( os, i->node, i->instanceID, first );
+        first = false;
+
+        // slave queue holds only the head version now
+        i->lagging = false;
+        i->catchUp = false;
+        if( i->maxVersions > 0 )
+            i->maxVersion = _version.low() - 1 + i->maxVersions;
+    }
+    if( first )
+        return;
+
+    LBLOG( LOG_OBJECTS ) << "Coalesced v" << _version << " of "
+                         << lunchbox::className( _object )
+                         << " for lagging slaves" << std::endl;
+    _updateMaxVersion();
+}
+
+void VersionedMasterCM::_sendHead( ObjectInstanceDataOStream& os,
+                                   NodePtr node, const uint32_t instanceID,
+                                   const bool first )
+{
+    // Use the unicast connection, which also carries the deltas of later
+    // commits. On multicast, those could overtake the catch-up.
+    if( first )
+    {
+        os.enableMap( _version, node, instanceID, false );
+        _object->getInstanceData( os );
+        os.disable();
+    }
+    else
+        os.sendMapData( node, instanceID, false );
+}
+
+Object::SlaveLags VersionedMasterCM::getSlaveLags() const
+{
+    Mutex mutex( _slaves );
+    Object::SlaveLags lags;
+    for( SlaveDatasCIter i = _slaveData.begin(); i != _slaveData.end(); ++i )
+    {
+        if( i->maxVersions == 0 )
+            continue;
+
+        // the slave acks maxVersion = applied version + maxVersions
+        const uint64_t applied = i->maxVersion - i->maxVersions;
+        const Object::SlaveLag lag = { i->node, i->instanceID,
+                                       _version.low() > applied ?
+                                       _version.low() - applied : 0 };
+        lags.push_back( lag );
+    }
+    return lags;
+}
+
 void VersionedMasterCM::_updateMaxVersion()
 {
     uint64_t maxVersion = std::numeric_limits< uint64_t >::max();
@@ -220,8 +388,31 @@ bool VersionedMasterCM::_cmdMaxVersion( ICommand& cmd )
         return true;
     }
 
+    // ignore outdated updates overtaken by _sendCatchUp()
+    if( _object->coalesceSlaveVersions() && version < i->maxVersion )
+        return true;
+
     i->maxVersion = version;
     _updateMaxVersion();
+
+    // A lagging slave which applied all versions sent to it needs the head
+    // version, even if the master does not commit anymore.
+    if( i->lagging && !i->catchUp && i->maxVersions > 0 &&
+        i->maxVersion - i->maxVersions >= i->lastVersion &&
+        i->lastVersion < _version.low( ))
+    {
+        i->catchUp = true;
+        ObjectOCommand( _object, _object->getLocalNode(), CMD_OBJECT_CATCH_UP,
+                        COMMANDTYPE_OBJECT, _object->getID(),
+                        _object->getInstanceID( ));
+    }
+    return true;
+}
+
+bool VersionedMasterCM::_cmdCatchUp( ICommand& )
+{
+    Mutex mutex( _slaves );
+    _sendCatchUp();
     return true;
 }
 
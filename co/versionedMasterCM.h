@@ -32,6 +32,8 @@
 
 namespace co
 {
+    class ObjectInstanceDataOStream;
+
     /**
      * @internal
      * The base class for versioned master change managers.
@@ -55,8 +57,14 @@ namespace co
             { Mutex mutex( _slaves ); return _version; }
         uint128_t getVersion() const override
             { Mutex mutex( _slaves ); return _version; }
+
+        bool isCommitBlocked() const override;
+        Object::SlaveLags getSlaveLags() const override;
         //@}
 
+        bool useMulticast() const override
+            { return !_object->coalesceSlaveVersions(); }
+
         bool isMaster() const override { return true; }
         uint32_t getMasterInstanceID() const override
             { LBDONTCALL; return CO_INSTANCE_INVALID; }
@@ -77,17 +85,50 @@ namespace co
         /** Maximum master version allowed to commit. */
         lunchbox::Monitor< uint64_t > _maxVersion;
 
+        /** The nodes receiving the next commit, see _updateReceivers(). */
+        Nodes _receivers;
+
+        /** Wait until the next version may be committed. */
+        void _waitCommitWindow();
+
+        /**
+         * Update _receivers for the next commit, called with _slaves locked.
+         *
+         * Excludes the nodes of lagging slave instances if the object
+         * coalesces versions, and selects the lagging instances to catch up.
+         */
+        void _updateReceivers();
+
+        /** Send the head version to all drained lagging slaves. */
+        void _sendCatchUp();
+
+        /**
+         * Send the head version to one lagging slave instance.
+         *
+         * Serializes the instance data into the given stream for the first
+         * slave, and resends the stream for further slaves.
+         */
+        virtual void _sendHead( ObjectInstanceDataOStream& os, NodePtr node,
+                                const uint32_t instanceID, const bool first );
+
     private:
         struct SlaveData
         {
             SlaveData() : maxVersion( std::numeric_limits< uint64_t >::max( ))
-                        , instanceID( LB_UNDEFINED_UINT32 ) {}
+                        , maxVersions( 0 ), lastVersion( 0 )
+                        , instanceID( LB_UNDEFINED_UINT32 ), lagging( false )
+                        , catchUp( false )
+                {}
             bool operator == ( const SlaveData& rhs ) const
                 { return node == rhs.node && instanceID == rhs.instanceID; }
 
             NodePtr node;
             uint64_t maxVersion;
+            uint64_t maxVersions; //!< queue size of slave, 0 if unlimited
+            uint64_t lastVersion; //!< last version send before lagging
             uint32_t instanceID;
+            bool lagging;         //!< excluded from commits
+            bool catchUp;         //!< send head version in _sendCatchUp()
         };
         typedef std::vector< SlaveData > SlaveDatas;
         typedef SlaveDatas::const_iterator SlaveDatasCIter;
@@ -100,11 +141,13 @@ namespace co
         DataIStreamQueue _slaveCommits;
 
         uint128_t _apply( ObjectDataIStream* is );
+        uint128_t _apply( const ObjectDataIStreams& commits );
         void _updateMaxVersion();
 
         /* The command handlers. */
         bool _cmdSlaveDelta( ICommand& command );
         bool _cmdMaxVersion( ICommand& command );
+        bool _cmdCatchUp( ICommand& command );
         bool _cmdDiscard( ICommand& ) { return true; }
 
         LB_TS_VAR( _cmdThread );
@@ -20,6 +20,8 @@
 
 #include "versionedSlaveCM.h"
 
+#include "binaryDelta.h"
+#include "bufferDataIStream.h"
 #include "log.h"
 #include "object.h"
 #include "objectDataICommand.h"
@@ -41,6 +43,7 @@ VersionedSlaveCM::VersionedSlaveCM( Object* object, uint32_t masterInstanceID )
         , _ostream( this )
 #pragma warning(pop)
         , _masterInstanceID( masterInstanceID )
+        , _resync( false )
 {
     LBASSERT( object );
 
@@ -149,12 +152,32 @@ uint128_t VersionedSlaveCM::getHeadVersion() const
 void VersionedSlaveCM::_unpackOneVersion( ObjectDataIStream* is )
 {
     LBASSERT( is );
-    LBASSERTINFO( _version == is->getVersion() - 1 || _version == VERSION_NONE,
+    if( _object->getChangeType() == Object::DIFF && !is->hasInstanceData( ))
+    {
+        if( _resync || !_applyDiff( *is ))
+        {
+            // wait for the full version requested from the master
+            _releaseStream( is );
+            return;
+        }
+        _version = is->getVersion();
+        _sendAck();
+        _releaseStream( is );
+        return;
+    }
+    if( _resync && is->getVersion() <= _version )
+    {
+        _releaseStream( is ); // outdated
+        return;
+    }
+    // instance data may skip versions coalesced by the master
+    LBASSERTINFO( _version == is->getVersion() - 1 || _version == VERSION_NONE ||
+                  ( is->hasInstanceData() && _version < is->getVersion( )),
                   "Expected version " << _version + 1 << " or 0, got "
                   << is->getVersion() << " for " << *_object );
 
     if( is->hasInstanceData( ))
-        _object->applyInstanceData( *is );
+        _applyInstanceData( *is );
     else
         _object->unpack( *is );
 
@@ -175,13 +198,52 @@ void VersionedSlaveCM::_unpackOneVersion( ObjectDataIStream* is )
     _releaseStream( is );
 }
 
+void VersionedSlaveCM::_applyInstanceData( ObjectDataIStream& is )
+{
+    if( _object->getChangeType() != Object::DIFF )
+    {
+        _object->applyInstanceData( is );
+        return;
+    }
+
+    _image.setSize( 0 );
+    for( uint64_t size = is.getRemainingBufferSize(); size > 0;
+         size = is.getRemainingBufferSize( ))
+    {
+        _image.append( static_cast< const uint8_t* >(
+                           is.getRemainingBuffer( size )), size );
+    }
+    _resync = false;
+
+    BufferDataIStream image( _image, is );
+    _object->applyInstanceData( image );
+}
+
+bool VersionedSlaveCM::_applyDiff( ObjectDataIStream& is )
+{
+    if( !BinaryDelta::decode( is, _version, _image ))
+    {
+        LBINFO << "Binary delta v" << is.getVersion() << " does not apply to v"
+               << _version << " of " << lunchbox::className( _object )
+               << ", requesting full version" << std::endl;
+        _resync = true;
+        _object->send( _master, CMD_OBJECT_FULL_VERSION, _masterInstanceID )
+            << _object->getInstanceID();
+        return false;
+    }
+
+    BufferDataIStream image( _image, is );
+    _object->applyInstanceData( image );
+    return true;
+}
+
 void VersionedSlaveCM::_sendAck()
 {
     const uint64_t maxVersion = _version.low() + _object->getMaxVersions();
     if( maxVersion <= _version.low( )) // overflow: default unblocking commit
         return;
 
-    _object->send( _master, CMD_OBJECT_MAX_VERSION, _masterInstanceID )
+    _object->sendControl( _master, CMD_OBJECT_MAX_VERSION, _masterInstanceID )
             << maxVersion << _object->getInstanceID();
 }
 
@@ -195,7 +257,7 @@ void VersionedSlaveCM::applyMapData( const uint128_t& version )
             LBASSERTINFO( is->hasInstanceData(), *_object );
 
             if( is->hasData( )) // not VERSION_NONE
-                _object->applyInstanceData( *is );
+                _applyInstanceData( *is );
             _version = is->getVersion();
 
             LBASSERT( _version != VERSION_INVALID );
@@ -341,8 +403,12 @@ bool VersionedSlaveCM::_cmdData( ICommand& cmd )
         _queuedVersions.getBack( debugStream );
         if ( debugStream )
         {
+            // a full version requested on resync may have the version of a
+            // queued delta, which is dropped when applying
             LBASSERT( debugStream->getVersion() + 1 == version ||
-                      debugStream->getVersion() == VERSION_NONE );
+                      debugStream->getVersion() == VERSION_NONE ||
+                      ( _currentIStream->hasInstanceData() &&
+                        debugStream->getVersion() <= version ));
         }
 #endif
         _queuedVersions.push( _currentIStream );
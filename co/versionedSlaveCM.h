@@ -25,6 +25,7 @@
 #include "objectDataIStream.h"      // member
 #include "objectSlaveDataOStream.h" // member
 
+#include <lunchbox/buffer.h>      // member
 #include <lunchbox/mtQueue.h>     // member
 #include <lunchbox/pool.h>        // member
 #include <lunchbox/thread.h>      // thread-safety macro
@@ -91,6 +92,12 @@ namespace co
         /** The instance identifier of the master object. */
         uint32_t _masterInstanceID;
 
+        /** The instance data of the current version for Object::DIFF. */
+        lunchbox::Bufferb _image;
+
+        /** Binary deltas are skipped until the next full version. */
+        bool _resync;
+
         void _syncToHead();
         void _releaseStream( ObjectDataIStream* stream );
         void _sendAck();
@@ -98,6 +105,12 @@ namespace co
         /** Apply the data in the input stream to the object */
         void _unpackOneVersion( ObjectDataIStream* is );
 
+        /** Apply instance data, retaining it for Object::DIFF. */
+        void _applyInstanceData( ObjectDataIStream& is );
+
+        /** Apply a binary delta, @return false if it does not fit _image. */
+        bool _applyDiff( ObjectDataIStream& is );
+
         /* The command handlers. */
         bool _cmdData( ICommand& command );
 
@@ -20,6 +20,7 @@
 #include <co/barrier.h>
 #include <co/connection.h>
 #include <co/connectionDescription.h>
+#include <co/global.h>
 #include <co/init.h>
 #include <co/node.h>
 #include <lunchbox/monitor.h>
@@ -110,22 +111,34 @@ int main( int argc, char **argv )
     lunchbox::RNG rng;
     _port =(rng.get<uint16_t>() % 60000) + 1024;
 
-    MasterThread master;
-    SlaveThread slave;
-
-    master.start();
-    slave.start();
+    // plain, with a pool of object command threads, with control connections
+    // and with padded command framing
+    for( int32_t run = 0; run < 4; ++run )
+    {
+        co::Global::setIAttribute( co::Global::IATTR_OBJECT_COMMAND_THREADS,
+                                   run == 1 ? 4 : 0 );
+        co::Global::setIAttribute( co::Global::IATTR_NODE_CONTROL_CONNECTION,
+                                   run == 2 ? 1 : 0 );
+        co::Global::setIAttribute( co::Global::IATTR_COMMAND_COMPACT_FRAMING,
+                                   run == 3 ? 0 : 1 );
+        MasterThread master;
+        SlaveThread slave;
+
+        master.start();
+        slave.start();
 
-    _barrier.waitNE( 0 );
-    std::cerr << "Main enter" << std::endl;
-    _barrier->enter();
-    std::cerr << "Main left" << std::endl;
-    _barrier = 0;
+        _barrier.waitNE( 0 );
+        std::cerr << "Main enter" << std::endl;
+        _barrier->enter();
+        std::cerr << "Main left" << std::endl;
+        _barrier = 0;
 
-    slave.join();
-    _barrier = 0;
+        slave.join();
+        _barrier = 0;
 
-    master.join();
+        master.join();
+        _port += 2;
+    }
 
     co::exit();
     return EXIT_SUCCESS;
@@ -18,10 +18,13 @@
 #include <test.h>
 
 #include <co/co.h>
+#include <lunchbox/clock.h>
 #include <lunchbox/monitor.h>
 #include <lunchbox/mtQueue.h>
 #include <lunchbox/spinLock.h>
 
+#include <iostream>
+
 lunchbox::Monitorb _registered( false );
 lunchbox::Monitorb _mapped( false );
 lunchbox::Monitorb _done( false );
@@ -31,6 +34,7 @@ lunchbox::MTQueue< co::uint128_t > _versions;
 const size_t _latency( 1 );
 const size_t _numThreads( 3 );
 const size_t _numIterations( 100 );
+uint32_t _options( co::Barrier::OPTION_NONE );
 
 class ServerThread : public lunchbox::Thread
 {
@@ -93,6 +97,7 @@ public:
         if( _master )
         {
             _barrier = new co::Barrier( _node, _barrierID );
+            _barrier->setOptions( _options );
             _mapped = true;
         }
         else
@@ -131,20 +136,45 @@ int main( int argc, char **argv )
     node->addConnectionDescription( desc );
     TEST( node->listen( ));
 
-    ServerThread master( node );
-    master.start();
+    const uint32_t options[] = { co::Barrier::OPTION_NONE,
+                                 co::Barrier::OPTION_SPIN,
+                                 co::Barrier::OPTION_LOCAL,
+                                 co::Barrier::OPTION_SPIN |
+                                     co::Barrier::OPTION_LOCAL };
+    const char* names[] = { "blocking", "spin", "local", "spin+local" };
+
+    for( size_t i = 0; i < sizeof( options ) / sizeof( uint32_t ); ++i )
+    {
+        _options = options[i];
+        _registered = false;
+        _mapped = false;
+        _done = false;
 
-    std::vector< WorkerThread* > workers;
-    for( size_t i = 0; i < _numThreads; ++i )
-        workers.push_back( new WorkerThread( node, i == 0 ));
+        ServerThread master( node );
+        master.start();
 
-    for( size_t i = 0; i < _numThreads; ++i )
-        workers[i]->start();
+        std::vector< WorkerThread* > workers;
+        for( size_t j = 0; j < _numThreads; ++j )
+            workers.push_back( new WorkerThread( node, j == 0 ));
 
-    for( size_t i = 0; i < _numThreads; ++i )
-        workers[i]->join();
+        lunchbox::Clock clock;
+        for( size_t j = 0; j < _numThreads; ++j )
+            workers[j]->start();
+
+        for( size_t j = 0; j < _numThreads; ++j )
+        {
+            workers[j]->join();
+            delete workers[j];
+        }
+        const float time = clock.getTimef();
+
+        master.join();
+        _versions.clear();
+
+        std::cout << names[i] << ": " << time / float( _numIterations )
+                  << " ms/barrier" << std::endl;
+    }
 
-    master.join();
     node->close();
 
     TEST( co::exit( ));
@@ -0,0 +1,126 @@
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the CommandQueue with concurrent producers: no command is lost or
+// duplicated, and the commands of each producer are popped in push order.
+#include <test.h>
+#include <co/buffer.h>
+#include <co/commandQueue.h>
+#include <co/iCommand.h>
+#include <co/localNode.h>
+#include <co/oCommand.h>
+
+#include <lunchbox/thread.h>
+
+#define NPRODUCERS (4)
+#define NCOMMANDS  (50000) // per producer
+
+namespace
+{
+class Producer : public lunchbox::Thread
+{
+public:
+    Producer( co::CommandQueue& queue, const co::ICommand& command,
+              const uint32_t id )
+        : _queue( queue ), _command( command ), _id( id ) {}
+
+    void run() override
+    {
+        for( uint32_t i = 0; i < NCOMMANDS; ++i )
+        {
+            co::ICommand command( _command );
+            command.setCommand( _id << 24 | i ); // producer and sequence
+            _queue.push( command );
+        }
+    }
+
+private:
+    co::CommandQueue& _queue;
+    const co::ICommand& _command;
+    const uint32_t _id;
+};
+
+void _testProducers( co::CommandQueue& queue, const co::ICommand& command )
+{
+    Producer* producers[ NPRODUCERS ];
+    for( uint32_t i = 0; i < NPRODUCERS; ++i )
+    {
+        producers[ i ] = new Producer( queue, command, i );
+        TEST( producers[ i ]->start( ));
+    }
+
+    uint32_t next[ NPRODUCERS ] = { 0 };
+    size_t nPopped = 0;
+    while( nPopped < NPRODUCERS * NCOMMANDS )
+    {
+        const co::ICommands& commands = queue.popAll();
+        TEST( !commands.empty( ));
+        for( co::ICommandsCIter i = commands.begin(); i != commands.end(); ++i )
+        {
+            const uint32_t producer = i->getCommand() >> 24;
+            const uint32_t sequence = i->getCommand() & 0xffffff;
+            TESTINFO( producer < NPRODUCERS, producer );
+            TESTINFO( sequence == next[ producer ],
+                      "producer " << producer << ": " << sequence << " != "
+                      << next[ producer ] );
+            ++next[ producer ];
+            ++nPopped;
+        }
+    }
+
+    for( uint32_t i = 0; i < NPRODUCERS; ++i )
+    {
+        TEST( producers[ i ]->join( ));
+        delete producers[ i ];
+    }
+    TEST( queue.isEmpty( ));
+    TEST( !queue.tryPop().isValid( ));
+}
+}
+
+int main( int, char** )
+{
+    co::LocalNodePtr node = new co::LocalNode;
+
+    const uint64_t size = co::OCommand::getSize();
+    co::BufferPtr buffer = new co::Buffer;
+    buffer->resize( size );
+    reinterpret_cast< uint64_t* >( buffer->getData( ))[ 0 ] = size;
+
+    co::ICommand command( node, node, buffer, false );
+    command.setType( co::COMMANDTYPE_NODE );
+
+    // unbounded, beyond the preallocated nodes
+    co::CommandQueue queue;
+    _testProducers( queue, command );
+
+    // bounded, producers block on a full queue
+    co::CommandQueue limited( 16 );
+    _testProducers( limited, command );
+
+    // pushFront overtakes queued commands
+    command.setCommand( 1 );
+    queue.push( command );
+    command.setCommand( 2 );
+    queue.pushFront( command );
+    TEST( queue.getSize() == 2 );
+    TEST( queue.pop().getCommand() == 2 );
+    TEST( queue.pop().getCommand() == 1 );
+    TEST( queue.isEmpty( ));
+
+    node = 0;
+    return EXIT_SUCCESS;
+}
@@ -21,6 +21,7 @@
 #include <co/connection.h>
 #include <co/connectionDescription.h>
 #include <co/connectionSet.h>
+#include <co/global.h>
 #include <co/init.h>
 
 #include <lunchbox/clock.h>
@@ -39,6 +40,7 @@ static co::ConnectionType types[] =
     co::CONNECTIONTYPE_NAMEDPIPE,
     co::CONNECTIONTYPE_RSP,
     co::CONNECTIONTYPE_RDMA,
+    co::CONNECTIONTYPE_TCPIP_STRIPED,
 //    co::CONNECTIONTYPE_UDT,
     co::CONNECTIONTYPE_NONE // must be last
 };
@@ -80,6 +82,8 @@ private:
 int main( int argc, char **argv )
 {
     co::init( argc, argv );
+    // stripe each packet over all sockets
+    co::Global::setIAttribute( co::Global::IATTR_TCP_STRIPE_UNIT, 4096 );
 
     for( size_t i = 0; types[i] != co::CONNECTIONTYPE_NONE; ++i )
     {
@@ -130,6 +134,12 @@ int main( int argc, char **argv )
             TEST( writer->connect( ));
 
             reader = listener->acceptSync();
+            // striped connections are complete once all sockets are accepted
+            while( !reader && desc->type == co::CONNECTIONTYPE_TCPIP_STRIPED )
+            {
+                listener->acceptNB();
+                reader = listener->acceptSync();
+            }
             break;
         }
         }
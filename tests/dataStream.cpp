@@ -25,6 +25,7 @@
 #include <co/connectionDescription.h>
 #include <co/dataIStream.h>
 #include <co/dataOStream.h>
+#include <co/fields.h>
 #include <co/init.h>
 
 #include <lunchbox/thread.h>
@@ -39,6 +40,18 @@
 static const std::string _message( "So long, and thanks for all the fish" );
 static const std::string _lorem( "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Ut eget felis sed leo tincidunt dictum eu eu felis. Aenean aliquam augue nec elit tristique tempus. Pellentesque dignissim adipiscing tellus, ut porttitor nisl lacinia vel. Donec malesuada lobortis velit, nec lobortis metus consequat ac. Ut dictum rutrum dui. Pellentesque quis risus at lectus bibendum laoreet. Suspendisse tristique urna quis urna faucibus et auctor risus ultricies. Morbi vitae mi vitae nisi adipiscing ultricies ac in nulla. Nam mattis venenatis nulla, non posuere felis tempus eget. Cras dapibus ultrices arcu vel dapibus. Nam hendrerit lacinia consectetur. Donec ullamcorper nibh nisl, id aliquam nisl. Nunc at tortor a lacus tincidunt gravida vitae nec risus. Suspendisse potenti. Fusce tristique dapibus ipsum, sit amet posuere turpis fermentum nec. Nam nec ante dolor." );
 
+struct Camera
+{
+    int32_t count;
+    float position[3];
+    std::string name;
+    double weight;
+    uint16_t flags;
+};
+CO_FIELDS( Camera, (count)(position)(name)(weight)(flags) )
+
+typedef co::Fields< Camera > CameraFields;
+
 class DataOStream : public co::DataOStream
 {
 public:
@@ -138,7 +151,38 @@ protected:
         std::string strings[2] = { _message, _lorem };
         stream << co::Array< std::string >( strings, 2 );
 
+        const Camera camera = { 7, { 1.f, 2.f, 3.f }, _message, 0.5, 17 };
+        co::serializeFields( stream, camera );
+        co::serializeFields( stream, camera, CameraFields::DIRTY_position |
+                                             CameraFields::DIRTY_weight );
+
         stream.disable();
+
+        ::DataOStream compact;
+        compact.setCompact( true );
+        compact._setupConnection( _connection );
+        compact._enable();
+
+        compact << foo << int16_t( -3 ) << int64_t( -1000000 )
+                << uint64_t( 0xFFFFFFFFFFFFFFFFull ) << 43.0f
+                << co::uint128_t( 1, 2 ) << _message;
+
+        co::ObjectVersions versions;
+        for( uint64_t i = 0; i < 1000; ++i )
+            versions.push_back( co::ObjectVersion( co::UUID( true ),
+                                                   co::uint128_t( 0, i )));
+        compact << versions;
+
+        std::vector< uint16_t > shorts( 100, 5 );
+        compact << shorts;
+
+        std::set< uint32_t > ids;
+        for( uint32_t i = 0; i < 1000; ++i )
+            ids.insert( i * 7 + 0x10000000u );
+        compact << ids;
+        co::serializeFields( compact, camera );
+
+        compact.disable();
     }
 
 private:
@@ -147,20 +191,9 @@ private:
 }
 }
 
-int main( int argc, char **argv )
+static void _receive( co::ConnectionPtr connection, ::DataIStream& stream,
+                      co::BufferCache& bufferCache )
 {
-    co::init( argc, argv );
-    co::ConnectionDescriptionPtr desc = new co::ConnectionDescription;
-    desc->type = co::CONNECTIONTYPE_PIPE;
-    co::ConnectionPtr connection = co::Connection::create( desc );
-
-    TEST( connection->connect( ));
-    TEST( connection->isConnected( ));
-    co::DataStreamTest::Sender sender( connection->acceptSync( ));
-    TEST( sender.start( ));
-
-    ::DataIStream stream;
-    co::BufferCache bufferCache( 200 );
     bool receiving = true;
     const size_t minSize = co::COMMAND_MINSIZE;
     const size_t cacheSize = co::COMMAND_ALLOCSIZE;
@@ -202,6 +235,23 @@ int main( int argc, char **argv )
                 TESTINFO( false, command.getCommand( ));
         }
     }
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    co::ConnectionDescriptionPtr desc = new co::ConnectionDescription;
+    desc->type = co::CONNECTIONTYPE_PIPE;
+    co::ConnectionPtr connection = co::Connection::create( desc );
+
+    TEST( connection->connect( ));
+    TEST( connection->isConnected( ));
+    co::DataStreamTest::Sender sender( connection->acceptSync( ));
+    TEST( sender.start( ));
+
+    ::DataIStream stream;
+    co::BufferCache bufferCache( 200 );
+    _receive( connection, stream, bufferCache );
 
     int foo;
     stream >> foo;
@@ -236,6 +286,59 @@ int main( int argc, char **argv )
     TEST( strings[0] == _message );
     TEST( strings[1] == _lorem );
 
+    Camera camera = Camera();
+    co::deserializeFields( stream, camera );
+    TEST( camera.count == 7 );
+    TEST( camera.position[0] == 1.f && camera.position[2] == 3.f );
+    TEST( camera.name == _message );
+    TEST( camera.weight == 0.5 );
+    TEST( camera.flags == 17 );
+
+    Camera partial = Camera();
+    co::deserializeFields( stream, partial, CameraFields::DIRTY_position |
+                                            CameraFields::DIRTY_weight );
+    TEST( partial.count == 0 );
+    TEST( partial.position[1] == 2.f );
+    TEST( partial.name.empty( ));
+    TEST( partial.weight == 0.5 );
+    TEST( partial.flags == 0 );
+
+    ::DataIStream compact;
+    _receive( connection, compact, bufferCache );
+    TEST( compact.isCompact( ));
+
+    compact >> foo;
+    TESTINFO( foo == 42, foo );
+    TEST( compact.read< int16_t >() == -3 );
+    TEST( compact.read< int64_t >() == -1000000 );
+    TEST( compact.read< uint64_t >() == 0xFFFFFFFFFFFFFFFFull );
+    TEST( compact.read< float >() == 43.f );
+    TEST( compact.read< co::uint128_t >() == co::uint128_t( 1, 2 ));
+    TEST( compact.read< std::string >() == _message );
+
+    co::ObjectVersions versions;
+    compact >> versions;
+    TEST( versions.size() == 1000 );
+    for( uint64_t i = 0; i < versions.size(); ++i )
+        TEST( versions[i].version == co::uint128_t( 0, i ));
+
+    std::vector< uint16_t > shorts;
+    compact >> shorts;
+    TEST( shorts == std::vector< uint16_t >( 100, 5 ));
+
+    std::set< uint32_t > ids;
+    compact >> ids;
+    TEST( ids.size() == 1000 );
+    TEST( *ids.begin() == 0x10000000u );
+    TEST( *ids.rbegin() == 999 * 7 + 0x10000000u );
+
+    camera = Camera();
+    co::deserializeFields( compact, camera );
+    TEST( camera.count == 7 );
+    TEST( camera.name == _message );
+    TEST( camera.flags == 17 );
+    TEST( !compact.hasData( ));
+
     TEST( sender.join( ));
     connection->close();
 
@@ -0,0 +1,160 @@
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests commits of modified co::Object::DIFF objects: binary deltas, the full
+// data fallback for large changes and the full version resync of a slave
+// whose data does not match the base of a delta.
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/rng.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <iostream>
+
+using co::uint128_t;
+namespace bp = boost::posix_time;
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object() : nApplied( 0 ) {}
+
+    std::vector< uint8_t > data;
+    size_t nApplied;
+
+protected:
+    ChangeType getChangeType() const override { return DIFF; }
+    void getInstanceData( co::DataOStream& os ) override { os << data; }
+    void applyInstanceData( co::DataIStream& is ) override
+    {
+        is >> data;
+        ++nApplied;
+    }
+};
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    lunchbox::RNG rng;
+    const uint16_t port = (rng.get<uint16_t>() % 60000) + 1024;
+
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = port;
+    connDesc->setHostname( "localhost" );
+
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( connDesc );
+
+    connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+
+    co::LocalNodePtr client = new co::LocalNode;
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+    TEST( client->connect( serverProxy ));
+
+    Object master;
+    master.data.resize( 4096, 0 );
+    TEST( client->registerObject( &master ));
+
+    // Mapped without data, so the first delta does not match the slave's
+    // (empty) base version and the slave requests the full version.
+    Object slave;
+    TEST( server->mapObject( &slave, master.getID(), co::VERSION_NONE ));
+    TEST( slave.getVersion() == co::VERSION_NONE );
+    TEST( slave.data.empty( ));
+
+    master.data[ 100 ] = 1;
+    uint128_t version = master.commit();
+    TEST( slave.sync( version ) == version );
+    TEST( slave.data == master.data );
+    TESTINFO( slave.nApplied == 1, slave.nApplied ); // only the full version
+
+    // small change: patched by a delta on top of the resynced data
+    master.data[ 1000 ] = 2;
+    version = master.commit();
+    TEST( slave.sync( version ) == version );
+    TEST( slave.data == master.data );
+    TESTINFO( slave.nApplied == 2, slave.nApplied );
+
+    // large change: more than half of the data, sent in full
+    for( size_t i = 0; i < master.data.size(); i += 2 )
+        master.data[ i ] = 3;
+    version = master.commit();
+    TEST( slave.sync( version ) == version );
+    TEST( slave.data == master.data );
+
+    // size change: the delta covers the appended data
+    master.data.resize( 4160, 4 );
+    version = master.commit();
+    TEST( slave.sync( version ) == version );
+    TEST( slave.data == master.data );
+    TESTINFO( slave.nApplied == 4, slave.nApplied );
+
+    // The full version requested for the first delta has the version of the
+    // second delta, which is already queued.
+    Object lateSlave;
+    TEST( server->mapObject( &lateSlave, master.getID(), co::VERSION_NONE ));
+
+    master.data[ 10 ] = 5;
+    const uint128_t first = master.commit();
+    master.data[ 20 ] = 6;
+    version = master.commit();
+    while( lateSlave.getHeadVersion() != version )
+        boost::this_thread::sleep( bp::milliseconds( 1 ));
+
+    TEST( lateSlave.sync( first ) == version );
+    TEST( lateSlave.data == master.data );
+    TESTINFO( lateSlave.nApplied == 1, lateSlave.nApplied );
+
+    server->unmapObject( &lateSlave );
+    server->unmapObject( &slave );
+    client->deregisterObject( &master );
+
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( ));
+    TEST( server->close( ));
+
+    serverProxy->printHolders( std::cerr );
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+
+    serverProxy = 0;
+    client      = 0;
+    server      = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
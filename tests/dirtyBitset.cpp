@@ -0,0 +1,68 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the element tracking of co::DirtyBitset
+#include <test.h>
+#include <co/dirtyBitset.h>
+#include <co/init.h>
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    co::DirtyBitset bitset( 10000 );
+    TEST( bitset.getSize() == 10000 );
+    TEST( bitset.isEmpty( ));
+    TEST( bitset.getRanges().empty( ));
+
+    bitset.set( 5 );
+    bitset.set( 6 );
+    bitset.set( 60, 70 );   // spans two words
+    bitset.set( 4095 );     // end of the first block
+    bitset.set( 4096 );     // start of the second block
+    bitset.set( 9000, 9100 );
+    TEST( !bitset.isEmpty( ));
+    TEST( bitset.isSet( 6 ));
+    TEST( !bitset.isSet( 7 ));
+
+    co::DirtyBitset::Ranges ranges = bitset.getRanges();
+    TESTINFO( ranges.size() == 4, ranges.size( ));
+    TEST( ranges[0] == co::DirtyBitset::Range( 5, 7 ));
+    TEST( ranges[1] == co::DirtyBitset::Range( 60, 70 ));
+    TEST( ranges[2] == co::DirtyBitset::Range( 4095, 4097 ));
+    TEST( ranges[3] == co::DirtyBitset::Range( 9000, 9100 ));
+
+    bitset.unset( 4095 );
+    ranges = bitset.getRanges();
+    TEST( ranges[2] == co::DirtyBitset::Range( 4096, 4097 ));
+
+    bitset.resize( 9050 );
+    ranges = bitset.getRanges();
+    TEST( ranges.back() == co::DirtyBitset::Range( 9000, 9050 ));
+
+    bitset.set( 20000 ); // grows
+    TEST( bitset.getSize() == 20001 );
+    TEST( bitset.isSet( 20000 ));
+
+    bitset.clear();
+    TEST( bitset.isEmpty( ));
+    TEST( bitset.getRanges().empty( ));
+    TEST( bitset.getSize() == 20001 );
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,7 @@
 
 #include <test.h>
 
+#include <co/completionGroup.h>
 #include <co/connection.h>
 #include <co/connectionDescription.h>
 #include <co/dataIStream.h>
@@ -131,7 +132,7 @@ int main( int argc, char **argv )
     nodes.push_back( serverProxy );
 
     lunchbox::Clock clock;
-    for( uint64_t i = co::Object::NONE+1; i <= co::Object::UNBUFFERED; ++i )
+    for( uint64_t i = co::Object::NONE+1; i <= co::Object::DIFF; ++i )
     {
         const co::Object::ChangeType type = co::Object::ChangeType( i );
         Object object( type );
@@ -150,6 +151,21 @@ int main( int argc, char **argv )
         TEST( object.nSync == 0 );
         TEST( server->object->nSync == 2 );
 
+        // asynchronous map and sync, completed from the command thread
+        Object mapped( type );
+        Object synced( type );
+        co::CompletionGroup group;
+        server->mapObject( &mapped, object.getID(), 0, co::VERSION_NONE,
+                           group.add( ));
+        client->syncObject( &synced, serverProxy, object.getID(),
+                            CO_INSTANCE_ALL, group.add( ));
+        TESTINFO( group.wait( ), "type " << type );
+        TEST( group.getNumPending() == 0 );
+        TEST( mapped.isAttached( ));
+        TEST( mapped.nSync == 1 );
+        TEST( synced.nSync == 1 );
+        server->unmapObject( &mapped );
+
         server->unmapObject( server->object );
         delete server->object;
         server->object = 0;
@@ -159,7 +175,7 @@ int main( int argc, char **argv )
     const float time = clock.getTimef();
     nodes.clear();
 
-    std::cout << time << "ms for " << int( co::Object::UNBUFFERED )
+    std::cout << time << "ms for " << int( co::Object::DIFF )
               << " object types" << std::endl;
 
     TEST( client->disconnect( serverProxy ));
@@ -151,6 +151,34 @@ int main( int argc, char **argv )
         client->objectMap.sync( server->objectMap.commit( ));
         TEST( clientBar.message == "hello again" );
 
+        // Test map() using a late-joining map with many entries
+        Bar masterBars[ 100 ];
+        for( size_t i = 0; i < 100; ++i )
+            TEST( server->objectMap.register_( &masterBars[i], TYPE_BAR ));
+        masterFoo.message = "hello late foo";
+        server->objectMap.commit();
+        masterFoo.message = "hello later foo";
+        const co::uint128_t version = server->objectMap.commit();
+
+        co::ObjectMap lateMap( *client, client->factory );
+        TEST( client->mapObject( &lateMap, server->objectMap.getID(),
+                                 version ));
+        Foo lateFoo;
+        TEST( lateMap.map( masterFoo.getID(), &lateFoo ) == &lateFoo );
+        TEST( lateFoo.message == "hello later foo" );
+        TEST( lateFoo.getVersion() == masterFoo.getVersion( ));
+
+        for( size_t i = 0; i < 100; ++i )
+            TEST( server->objectMap.deregister( &masterBars[i] ));
+        masterFoo.message = "hello again foo";
+        client->objectMap.sync( server->objectMap.commit( ));
+        TEST( clientFoo->message == "hello again foo" );
+        lateMap.sync( server->objectMap.commit( ));
+        TEST( lateFoo.message == "hello again foo" );
+
+        lateMap.clear();
+        client->unmapObject( &lateMap );
+
         // Test deregister()
         TEST( server->objectMap.deregister( &masterBar ));
         masterBar.message = "still there?";
@@ -61,6 +61,29 @@ protected:
         }
 };
 
+class CoalescingObject : public Object
+{
+protected:
+    virtual bool coalesceSlaveVersions() const { return true; }
+};
+
+/** Unbuffered object distributing a counter, coalesced for lagging slaves */
+class CounterObject : public co::Object
+{
+public:
+    CounterObject() : value( 0 ) {}
+
+    uint32_t value;
+
+protected:
+    virtual ChangeType getChangeType() const { return UNBUFFERED; }
+    virtual uint64_t getMaxVersions() const { return 1; }
+    virtual bool coalesceSlaveVersions() const { return true; }
+
+    virtual void getInstanceData( co::DataOStream& os ) { os << value; }
+    virtual void applyInstanceData( co::DataIStream& is ) { is >> value; }
+};
+
 class Thread : public lunchbox::Thread
 {
 public:
@@ -117,6 +140,16 @@ int main( int argc, char **argv )
 
     lunchbox::Clock clock;
     master.commit();
+
+    // slave did not yet sync v2
+    TEST( master.isCommitBlocked( ));
+    TEST( master.tryCommit() == co::VERSION_INVALID );
+    TESTINFO( master.getVersion() == 2, master.getVersion( ));
+    const co::Object::SlaveLags lags = master.getSlaveLags();
+    TESTINFO( lags.size() == 1, lags.size( ));
+    TESTINFO( lags.front().versions == 1, lags.front().versions );
+    TEST( lags.front().instanceID == slave.getInstanceID( ));
+
     master.commit(); // should block
     const float time = clock.getTimef();
 
@@ -127,6 +160,63 @@ int main( int argc, char **argv )
     server->unmapObject( &slave );
     client->deregisterObject( &master );
 
+    // lagging slave skips the versions it did not receive
+    CoalescingObject coalescingMaster;
+    TEST( client->registerObject( &coalescingMaster ));
+
+    CoalescingObject coalescingSlave;
+    TEST( server->mapObject( &coalescingSlave, coalescingMaster.getID( )));
+
+    clock.reset();
+    for( size_t i = 0; i < 4; ++i )
+    {
+        TEST( !coalescingMaster.isCommitBlocked( ));
+        coalescingMaster.commit(); // never blocks
+    }
+    TESTINFO( coalescingMaster.getVersion() == 5,
+              coalescingMaster.getVersion( ));
+    TESTINFO( clock.getTimef() < 100.f, clock.getTimef( ));
+
+    TEST( coalescingSlave.sync( uint128_t(2) ) == uint128_t(2) );
+    while( coalescingMaster.getSlaveLags().front().versions > 3 )
+        boost::this_thread::sleep( bp::milliseconds( 1 ));
+
+    coalescingMaster.commit(); // sends v6 after v5 instead of v3..v6
+    TEST( coalescingSlave.sync( uint128_t(6) ) == uint128_t(6) );
+    TEST( coalescingSlave.getVersion() == uint128_t(6) );
+
+    server->unmapObject( &coalescingSlave );
+    client->deregisterObject( &coalescingMaster );
+
+    // commits while all slaves lag are only send with the catch-up
+    CounterObject counterMaster;
+    TEST( client->registerObject( &counterMaster ));
+
+    CounterObject counterSlave;
+    TEST( server->mapObject( &counterSlave, counterMaster.getID( )));
+
+    for( uint32_t i = 1; i <= 4; ++i )
+    {
+        counterMaster.value = i;
+        counterMaster.commit();
+    }
+    TESTINFO( counterMaster.getVersion() == 5, counterMaster.getVersion( ));
+
+    TEST( counterSlave.sync( uint128_t(2) ) == uint128_t(2) );
+    TESTINFO( counterSlave.value == 1, counterSlave.value );
+
+    // the ack for v2 triggers the catch-up, the master does not commit
+    TEST( counterSlave.sync( uint128_t(5) ) == uint128_t(5) );
+    TESTINFO( counterSlave.value == 4, counterSlave.value );
+
+    counterMaster.value = 5;
+    counterMaster.commit(); // catch-up with v6 after the ack for v5
+    TEST( counterSlave.sync( uint128_t(6) ) == uint128_t(6) );
+    TESTINFO( counterSlave.value == 5, counterSlave.value );
+
+    server->unmapObject( &counterSlave );
+    client->deregisterObject( &counterMaster );
+
     TEST( client->disconnect( serverProxy ));
     TEST( client->close( ));
     TEST( server->close( ));
@@ -19,12 +19,32 @@
 
 #include <lunchbox/thread.h>
 #include <co/buffer.h>
+#include <co/commands.h>
 #include <co/init.h>
+#include <co/oCommand.h>
 
 #include <iostream>
 
 #include <co/pipeConnection.h> // private header
 
+#define NCOMMANDS (4)
+
+/** Counts the writes to the pipe. */
+class CountingPipe : public co::PipeConnection
+{
+public:
+    CountingPipe() : nWrites( 0 ) {}
+
+    size_t nWrites;
+
+protected:
+    int64_t write( const void* buffer, const uint64_t bytes ) override
+    {
+        ++nWrites;
+        return co::PipeConnection::write( buffer, bytes );
+    }
+};
+
 class Server : public lunchbox::Thread
 {
 public:
@@ -42,13 +62,28 @@ protected:
                   co::Connection::STATE_CONNECTED );
 
             co::Buffer buffer;
-            _connection->recvNB( &buffer, 5 );
-
             co::BufferPtr syncBuffer;
+            _connection->recvNB( &buffer, 5 );
             TEST( _connection->recvSync( syncBuffer ));
             TEST( syncBuffer == &buffer );
             TEST( strcmp( "buh!", (char*)buffer.getData( )) == 0 );
 
+            // coalesced commands, padded to the minimum command size
+            co::Buffer commands;
+            _connection->recvNB( &commands, NCOMMANDS * co::COMMAND_MINSIZE );
+            TEST( _connection->recvSync( syncBuffer ));
+            TEST( syncBuffer == &commands );
+            for( size_t i = 0; i < NCOMMANDS; ++i )
+            {
+                const uint8_t* data = commands.getData() +
+                                      i * co::COMMAND_MINSIZE;
+                // size, type, command, payload
+                const uint32_t* fields =
+                    reinterpret_cast< const uint32_t* >( data + 8 );
+                TESTINFO( fields[ 1 ] == co::CMD_NODE_CUSTOM, fields[ 1 ] );
+                TESTINFO( fields[ 2 ] == i, fields[ 2 ] );
+            }
+
             _connection->close();
             _connection = 0;
         }
@@ -59,7 +94,7 @@ private:
 int main( int argc, char **argv )
 {
     co::init( argc, argv );
-    co::PipeConnectionPtr connection = new co::PipeConnection;
+    lunchbox::RefPtr< CountingPipe > connection = new CountingPipe;
     TEST( connection->connect( ));
 
     Server server;
@@ -69,6 +104,16 @@ int main( int argc, char **argv )
     const size_t nChars  = strlen( message ) + 1;
 
     TEST( connection->send( message, nChars ));
+    TEST( connection->nWrites == 1 );
+
+    // commands are coalesced until the connection is flushed
+    connection->setCoalescing( co::COMMAND_ALLOCSIZE );
+    for( uint32_t i = 0; i < NCOMMANDS; ++i )
+        co::OCommand( co::Connections( 1, connection.get( )),
+                      co::CMD_NODE_CUSTOM ) << i;
+    TESTINFO( connection->nWrites == 1, connection->nWrites );
+    TEST( connection->flush( ));
+    TESTINFO( connection->nWrites == 2, connection->nWrites );
 
     server.join();
 
@@ -64,9 +64,40 @@ int main( int argc, char **argv )
         TEST( !c5.isValid( ));
     }
 
+    // work stealing: qs prefetches all items, thief takes some of them
+    co::QueueSlave* thief = new co::QueueSlave;
+    thief->setStealMode( co::QueueSlave::STEAL_LOAD );
+    node->mapObject( thief, qm->getID(), co::VERSION_FIRST );
+    node->unmapObject( qs );
+    delete qs;
+    qs = new co::QueueSlave( 4, 4 );
+    node->mapObject( qs, qm->getID(), co::VERSION_FIRST );
+
+    for( uint32_t i = 0; i < 4; ++i )
+        qm->push() << i;
+
+    {
+        co::ObjectICommand c1 = qs->pop();
+        TEST( c1.isValid( ));
+        TEST( c1.get< uint32_t >() == 0 );
+
+        co::ObjectICommand c2 = thief->pop();
+        TEST( c2.isValid( ));
+        TEST( c2.get< uint32_t >() == 3 );
+
+        co::ObjectICommand c3 = qs->pop();
+        co::ObjectICommand c4 = qs->pop();
+        co::ObjectICommand c5 = qs->pop();
+        TEST( c3.isValid( ));
+        TEST( c4.isValid( ));
+        TEST( !c5.isValid( ));
+    }
+
+    node->unmapObject( thief );
     node->unmapObject( qs );
     node->deregisterObject( qm );
 
+    delete thief;
     delete qs;
     delete qm;
 
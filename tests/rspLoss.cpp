@@ -0,0 +1,130 @@
+/* Copyright (c) 2014, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests RSP transfers with simulated datagram loss. Single losses within a
+// parity block are recovered from the parity without repeating data.
+#include <test.h>
+#include <co/buffer.h>
+#include <co/connectionDescription.h>
+#include <co/global.h>
+#include <co/init.h>
+#include <co/rspConnection.h> // private header
+
+#include <lunchbox/thread.h>
+
+#define PACKETSIZE (12345)
+#define NPACKETS   (2345)
+#define BLOCK      (16)
+#define LOSS       (37) // drop every LOSSth datagram, at most one per block
+
+namespace
+{
+class Reader : public lunchbox::Thread
+{
+public:
+    Reader( co::ConnectionPtr connection ) : connection_( connection )
+    {
+        TEST( start( ));
+    }
+
+    void run() override
+    {
+        co::Buffer buffer;
+        co::BufferPtr syncBuffer;
+
+        for( size_t i = 0; i < NPACKETS; ++i )
+        {
+            connection_->recvNB( &buffer, PACKETSIZE );
+            TEST( connection_->recvSync( syncBuffer ));
+            TEST( syncBuffer == &buffer );
+            TEST( buffer.getSize() == PACKETSIZE );
+
+            const uint8_t* data = buffer.getData();
+            for( size_t j = 0; j < PACKETSIZE; j += 1024 )
+                TESTINFO( data[j] == uint8_t( i + j ), i << ", " << j );
+            buffer.setSize( 0 );
+        }
+        connection_ = 0;
+    }
+
+private:
+    co::ConnectionPtr connection_;
+};
+
+co::RSPConnectionPtr _listen()
+{
+    co::ConnectionDescriptionPtr desc = new co::ConnectionDescription;
+    desc->type = co::CONNECTIONTYPE_RSP;
+    desc->setHostname( "239.255.12.35" );
+
+    co::RSPConnectionPtr connection = static_cast< co::RSPConnection* >(
+        co::Connection::create( desc ).get( ));
+    TEST( connection );
+    TEST( connection->listen( ));
+    connection->acceptNB();
+    return connection;
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    co::Global::setIAttribute( co::Global::IATTR_RSP_PARITY_BLOCK, BLOCK );
+    co::Global::setIAttribute( co::Global::IATTR_RSP_TEST_LOSS, LOSS );
+    co::Global::setIAttribute( co::Global::IATTR_RSP_MULTICAST_LOOPBACK, 1 );
+
+    // two group members in one process, the second one reads from the first
+    co::RSPConnectionPtr writer = _listen();
+    co::RSPConnectionPtr listener = _listen();
+
+    co::RSPConnectionPtr reader;
+    do // skip the connection of the listener itself
+    {
+        reader = static_cast< co::RSPConnection* >(
+            listener->acceptSync().get( ));
+        listener->acceptNB();
+    }
+    while( reader && reader->getID() != writer->getID( ));
+    TEST( reader );
+
+    Reader readThread( reader );
+    uint8_t out[ PACKETSIZE ];
+    for( size_t i = 0; i < NPACKETS; ++i )
+    {
+        for( size_t j = 0; j < PACKETSIZE; j += 1024 )
+            out[j] = uint8_t( i + j );
+        TEST( writer->send( out, PACKETSIZE ));
+    }
+    writer->finish();
+    readThread.join();
+
+    // The reader waits for the parity instead of requesting single losses
+    // early, so only a few datagrams are repeated.
+    const co::RSPConnection::Statistics stats = writer->getStatistics();
+    const uint64_t nLost = stats.datagramsSent / LOSS;
+    TESTINFO( stats.datagramsRepeated < nLost / 2,
+              stats.datagramsRepeated << " repeats for " << nLost
+              << " lost datagrams" );
+
+    reader = 0;
+    listener->close();
+    writer->close();
+    listener = 0;
+    writer = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests recovery of lost RSP datagrams from the XOR parity of a block
+#include <test.h>
+#include <co/init.h>
+#include <co/rspParity.h> // private header
+
+#include <lunchbox/rng.h>
+
+#define MAXSIZE  (1458)
+#define BLOCK    (16)
+#define NBLOCKS  (1000)
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    std::vector< std::vector< uint8_t > > datagrams( BLOCK );
+    co::RSPParity writer( MAXSIZE );
+    co::RSPParity reader( MAXSIZE );
+
+    for( size_t i = 0; i < NBLOCKS; ++i )
+    {
+        const uint16_t sequence = uint16_t( i * BLOCK );
+        writer.reset( sequence );
+        for( size_t j = 0; j < BLOCK; ++j )
+        {
+            // mostly full datagrams, some short ones and empty ones
+            const uint16_t size = ( rng.get< uint8_t >() < 192 ) ? MAXSIZE :
+                                  rng.get< uint16_t >() % MAXSIZE;
+            datagrams[j].resize( size );
+            for( size_t k = 0; k < size; ++k )
+                datagrams[j][k] = rng.get< uint8_t >();
+
+            writer.add( datagrams[j].data(), size );
+        }
+        TEST( writer.getSequence() == sequence );
+        TEST( writer.getCount() == BLOCK );
+
+        // inject loss of one datagram
+        const size_t lost = rng.get< uint16_t >() % BLOCK;
+        reader.reset( sequence );
+        for( size_t j = 0; j < BLOCK; ++j )
+        {
+            if( j != lost )
+                reader.add( datagrams[j].data(),
+                            uint16_t( datagrams[j].size( )));
+        }
+        TEST( reader.getCount() == BLOCK - 1 );
+
+        std::vector< uint8_t > parity( writer.getData(),
+                                       writer.getData() + writer.getLength( ));
+        uint16_t size = writer.getSizes();
+        reader.apply( parity.data(), uint32_t( parity.size( )), size );
+
+        TESTINFO( size == datagrams[ lost ].size(),
+                  size << " != " << datagrams[ lost ].size() << " block " <<
+                  i << " lost " << lost );
+        TESTINFO( ::memcmp( parity.data(), datagrams[ lost ].data(),
+                            size ) == 0, "block " << i << " lost " << lost );
+    }
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
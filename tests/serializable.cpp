@@ -0,0 +1,227 @@
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests merging of queued slave commits on co::Serializable masters and
+// element ranges tracked by co::DirtyBitset
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/dirtyBitset.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/serializable.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/rng.h>
+
+#include <iostream>
+
+using co::uint128_t;
+
+namespace
+{
+class Object : public co::Serializable
+{
+public:
+    Object() : a( 0 ), b( 0 ) {}
+
+    enum DirtyBits
+    {
+        DIRTY_A = co::Serializable::DIRTY_CUSTOM << 0,
+        DIRTY_B = co::Serializable::DIRTY_CUSTOM << 1
+    };
+
+    void setA( const uint32_t value ) { a = value; setDirty( DIRTY_A ); }
+    void setB( const uint32_t value ) { b = value; setDirty( DIRTY_B ); }
+
+    uint32_t a;
+    uint32_t b;
+    lunchbox::a_int32_t nA; //!< number of deserialized a values
+    lunchbox::a_int32_t nB; //!< number of deserialized b values
+    lunchbox::Monitor< uint32_t > nCommits; //!< received slave commits
+
+protected:
+    bool mergeSlaveCommits() const override { return true; }
+    bool isDeserializeParallel() const override { return true; }
+    void notifyNewVersion() override { ++nCommits; }
+
+    void serialize( co::DataOStream& os, const uint64_t dirty ) override
+    {
+        if( dirty & DIRTY_A )
+            os << a;
+        if( dirty & DIRTY_B )
+            os << b;
+    }
+
+    void deserialize( co::DataIStream& is, const uint64_t dirty ) override
+    {
+        if( dirty & DIRTY_A )
+        {
+            is >> a;
+            ++nA;
+        }
+        if( dirty & DIRTY_B )
+        {
+            is >> b;
+            ++nB;
+        }
+    }
+};
+
+class ArrayObject : public co::Serializable
+{
+public:
+    ArrayObject() : values( 1000 ), _dirtyValues( 1000 )
+        { setDirtyBitset( DIRTY_VALUES, &_dirtyValues ); }
+
+    enum DirtyBits
+    {
+        DIRTY_VALUES = co::Serializable::DIRTY_CUSTOM << 0
+    };
+
+    void set( const size_t first, const size_t last, const uint32_t value )
+    {
+        for( size_t i = first; i < last; ++i )
+            values[i] = value;
+        setDirtyRange( DIRTY_VALUES, first, last );
+    }
+
+    std::vector< uint32_t > values;
+    lunchbox::Monitor< uint32_t > nCommits; //!< received slave commits
+
+protected:
+    bool mergeSlaveCommits() const override { return true; }
+    void notifyNewVersion() override { ++nCommits; }
+
+    void serialize( co::DataOStream& os, const uint64_t dirty ) override
+    {
+        if( dirty & DIRTY_VALUES )
+            _dirtyValues.write( os, values, dirty == DIRTY_ALL );
+    }
+
+    void deserialize( co::DataIStream& is, const uint64_t dirty ) override
+    {
+        if( dirty & DIRTY_VALUES )
+            TEST( co::DirtyBitset::read( is, values ));
+    }
+
+private:
+    co::DirtyBitset _dirtyValues;
+};
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    lunchbox::RNG rng;
+    const uint16_t port = (rng.get<uint16_t>() % 60000) + 1024;
+
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = port;
+    connDesc->setHostname( "localhost" );
+
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( connDesc );
+
+    connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+
+    co::LocalNodePtr client = new co::LocalNode;
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+    TEST( client->connect( serverProxy ));
+
+    Object master;
+    TEST( client->registerObject( &master ));
+
+    Object slave;
+    TEST( server->mapObject( &slave, master.getID( )));
+
+    // queue slave commits, the first one is fully overwritten by the last one
+    slave.setA( 1 );
+    TEST( slave.commit() != co::VERSION_NONE );
+    slave.setB( 2 );
+    TEST( slave.commit() != co::VERSION_NONE );
+    slave.setA( 3 );
+    const uint128_t last = slave.commit();
+    TEST( last != co::VERSION_NONE );
+
+    master.nCommits.waitGE( 3 ); // all commits are queued
+    TEST( master.sync( co::VERSION_HEAD ) == last );
+
+    TESTINFO( master.a == 3, master.a );
+    TESTINFO( master.b == 2, master.b );
+    TESTINFO( master.nA == 1, master.nA ); // the first commit was dropped
+    TESTINFO( master.nB == 1, master.nB );
+
+    server->unmapObject( &slave );
+    client->deregisterObject( &master );
+
+    // modified element ranges of a master commit
+    ArrayObject arrayMaster;
+    arrayMaster.set( 0, 1000, 1 );
+    TEST( client->registerObject( &arrayMaster ));
+
+    ArrayObject arraySlave;
+    TEST( server->mapObject( &arraySlave, arrayMaster.getID( )));
+    TEST( arraySlave.values == arrayMaster.values );
+
+    arrayMaster.set( 10, 20, 2 );
+    arrayMaster.set( 500, 501, 3 );
+    TEST( arraySlave.sync( arrayMaster.commit( )) == arrayMaster.getVersion( ));
+    TEST( arraySlave.values == arrayMaster.values );
+
+    // ranges of merged slave commits sharing the dirty bit accumulate
+    arraySlave.set( 100, 110, 4 );
+    TEST( arraySlave.commit() != co::VERSION_NONE );
+    arraySlave.set( 200, 210, 5 );
+    const uint128_t lastRange = arraySlave.commit();
+    TEST( lastRange != co::VERSION_NONE );
+
+    arrayMaster.nCommits.waitGE( 2 ); // all commits are queued
+    TEST( arrayMaster.sync( co::VERSION_HEAD ) == lastRange );
+    TESTINFO( arrayMaster.values[ 105 ] == 4, arrayMaster.values[ 105 ] );
+    TESTINFO( arrayMaster.values[ 205 ] == 5, arrayMaster.values[ 205 ] );
+    TEST( arraySlave.values == arrayMaster.values );
+
+    server->unmapObject( &arraySlave );
+    client->deregisterObject( &arrayMaster );
+
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( ));
+    TEST( server->close( ));
+
+    serverProxy->printHolders( std::cerr );
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+
+    serverProxy = 0;
+    client      = 0;
+    server      = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -316,6 +316,7 @@ int main( int argc, char **argv )
     size_t packetSize = 1048576;
     size_t nPackets   = 0xffffffffu;
     uint32_t waitTime = 0;
+    int32_t nStripes  = 0;
 
     try // command line parsing
     {
@@ -343,7 +344,9 @@ int main( int argc, char **argv )
             ( "wait,w",       po::value<uint32_t>(&waitTime),
               "wait time (ms) between sends (client only)" )
             ( "delay,d",      po::value<uint32_t>(&_delay),
-              "wait time (ms) between receives (server only" );
+              "wait time (ms) between receives (server only" )
+            ( "stripes,k",    po::value<int32_t>(&nStripes),
+              "stripe TCPIP over k sockets, use on client and server" );
 
         // parse program options
         po::variables_map variableMap;
@@ -366,6 +369,14 @@ int main( int argc, char **argv )
             isClient = false;
             description->fromString(serverString);
         }
+
+        // compare with a plain TCPIP run to measure 1 versus k streams
+        if( nStripes > 0 && description->type == co::CONNECTIONTYPE_TCPIP )
+        {
+            description->type = co::CONNECTIONTYPE_TCPIP_STRIPED;
+            co::Global::setIAttribute( co::Global::IATTR_TCP_STRIPES,
+                                       nStripes );
+        }
     }
     catch( std::exception& exception )
     {